@@ -0,0 +1,232 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "SearchStats.h"
+
+// Замеры производительности на фиксированном корпусе задач. Каждый случай прогоняется
+// warmup раз вхолостую и repetitions раз с замером, в отчёт идут медиана и 95-й перцентиль
+// времени, узлы в секунду (по медиане) и пик памяти. Если система умеет сбрасывать пик
+// (Linux), он сбрасывается перед каждым случаем и столбец - пик самого случая ("case peak KB").
+// Иначе это пик процесса, который не убывает ("proc peak KB"), и порядок случаев фиксирован.
+// Результаты сохраняются в CSV; при сравнении с базовым файлом прошлого коммита рост
+// медианы больше допуска помечается как регрессия, изменение числа узлов - отдельно
+// (это изменение поведения поиска, а не шум).
+
+struct BenchmarkOptions {
+    int warmup = 1;
+    int repetitions = 5;
+    double tolerance = 0.10;      // допустимый рост медианы относительно базы
+    double noiseFloorMs = 1.0;    // разница меньше этого не считается регрессией
+    std::string filter;           // запускать только случаи, имя которых содержит подстроку
+    std::string baselineFile;
+    std::string saveFile;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    double medianMs = 0;
+    double p95Ms = 0;
+    long long nodes = 0;
+    double nodesPerSecond = 0;
+    size_t peakRssKB = 0; // пик случая, если сброс пика поддерживается, иначе пик процесса
+};
+
+// Разбор ключей --bench [--warmup N] [--reps N] [--tolerance X] [--noise-ms X] [--filter S]
+// [--baseline file] [--save file].
+// Возвращает true, если задан --bench
+inline bool parseBenchmarkArgs(int argc, char* argv[], BenchmarkOptions& options) {
+    bool enabled = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--bench") enabled = true;
+        else if (arg == "--warmup" && i + 1 < argc) options.warmup = std::atoi(argv[++i]);
+        else if (arg == "--reps" && i + 1 < argc) options.repetitions = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--tolerance" && i + 1 < argc) options.tolerance = std::atof(argv[++i]);
+        else if (arg == "--noise-ms" && i + 1 < argc) options.noiseFloorMs = std::atof(argv[++i]);
+        else if (arg == "--filter" && i + 1 < argc) options.filter = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc) options.baselineFile = argv[++i];
+        else if (arg == "--save" && i + 1 < argc) options.saveFile = argv[++i];
+    }
+    return enabled;
+}
+
+class BenchmarkSuite {
+public:
+    explicit BenchmarkSuite(const BenchmarkOptions& options) : options(options) {}
+
+    // run выполняет случай один раз и возвращает число узлов поиска (0, если не считается)
+    void add(const std::string& name, std::function<long long()> run) {
+        cases.push_back({ name, run });
+    }
+
+    // Прогон корпуса, сохранение и сравнение с базой. Возвращает 1, если есть регрессии.
+    // Формат потока out после вызова тот же, что до него
+    int run(std::ostream& out) {
+        FormatGuard guard(out);
+        std::vector<BenchmarkResult> results;
+        perCasePeak = resetPeakResident();
+        out << std::left << std::setw(28) << "case" << std::right << std::setw(12) << "median ms"
+            << std::setw(12) << "p95 ms" << std::setw(14) << "nodes" << std::setw(14) << "nodes/s"
+            << std::setw(15) << (perCasePeak ? "case peak KB" : "proc peak KB") << std::endl;
+
+        for (const Case& c : cases) {
+            if (!options.filter.empty() && c.name.find(options.filter) == std::string::npos) continue;
+            BenchmarkResult result = measure(c);
+            out << std::left << std::setw(28) << result.name << std::right << std::fixed << std::setprecision(3)
+                << std::setw(12) << result.medianMs << std::setw(12) << result.p95Ms
+                << std::setw(14) << result.nodes << std::setprecision(0) << std::setw(14) << result.nodesPerSecond
+                << std::setw(15) << result.peakRssKB << std::endl;
+            results.push_back(result);
+        }
+        lastResults = results;
+
+        if (!options.saveFile.empty()) {
+            std::ofstream file(options.saveFile);
+            if (file.is_open()) save(results, file);
+            else out << "Cannot write " << options.saveFile << std::endl;
+        }
+        if (!options.baselineFile.empty()) {
+            return compare(results, out);
+        }
+        return 0;
+    }
+
+    // Результат случая последнего прогона (nullptr, если случай не запускался)
+    const BenchmarkResult* find(const std::string& name) const {
+        for (const BenchmarkResult& r : lastResults) {
+            if (r.name == name) return &r;
+        }
+        return nullptr;
+    }
+
+private:
+    struct Case {
+        std::string name;
+        std::function<long long()> run;
+    };
+
+    // Сохраняет флаги, точность и заполнитель потока и восстанавливает их в деструкторе
+    class FormatGuard {
+    public:
+        explicit FormatGuard(std::ostream& stream) : stream(stream), flags(stream.flags()),
+            precision(stream.precision()), fill(stream.fill()) {
+        }
+        ~FormatGuard() {
+            stream.flags(flags);
+            stream.precision(precision);
+            stream.fill(fill);
+        }
+        FormatGuard(const FormatGuard&) = delete;
+        FormatGuard& operator=(const FormatGuard&) = delete;
+
+    private:
+        std::ostream& stream;
+        std::ios_base::fmtflags flags;
+        std::streamsize precision;
+        char fill;
+    };
+
+    BenchmarkOptions options;
+    std::vector<Case> cases;
+    std::vector<BenchmarkResult> lastResults;
+    bool perCasePeak = false;
+
+    BenchmarkResult measure(const Case& c) {
+        if (perCasePeak) resetPeakResident();
+        for (int i = 0; i < options.warmup; i++) c.run();
+
+        BenchmarkResult result;
+        result.name = c.name;
+        std::vector<double> times;
+        for (int i = 0; i < options.repetitions; i++) {
+            auto start = std::chrono::steady_clock::now();
+            result.nodes = c.run();
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        std::sort(times.begin(), times.end());
+        size_t n = times.size();
+        result.medianMs = n % 2 == 1 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+        result.p95Ms = times[std::min(n - 1, (n * 95 + 99) / 100 - 1)]; // ранговый перцентиль
+        result.nodesPerSecond = result.medianMs > 0 ? result.nodes * 1000.0 / result.medianMs : 0;
+        result.peakRssKB = peakResidentBytes() / 1024;
+        return result;
+    }
+
+    static void save(const std::vector<BenchmarkResult>& results, std::ostream& file) {
+        file << "case,median_ms,p95_ms,nodes,nodes_per_s,peak_rss_kb" << std::endl;
+        file << std::fixed << std::setprecision(3);
+        for (const BenchmarkResult& r : results) {
+            file << r.name << "," << r.medianMs << "," << r.p95Ms << "," << r.nodes << ","
+                << r.nodesPerSecond << "," << r.peakRssKB << std::endl;
+        }
+    }
+
+    static std::map<std::string, BenchmarkResult> load(std::istream& file) {
+        std::map<std::string, BenchmarkResult> results;
+        std::string line;
+        std::getline(file, line); // заголовок
+        while (std::getline(file, line)) {
+            std::stringstream ss(line);
+            BenchmarkResult r;
+            std::string field;
+            std::getline(ss, r.name, ',');
+            std::getline(ss, field, ','); r.medianMs = std::atof(field.c_str());
+            std::getline(ss, field, ','); r.p95Ms = std::atof(field.c_str());
+            std::getline(ss, field, ','); r.nodes = std::atoll(field.c_str());
+            std::getline(ss, field, ','); r.nodesPerSecond = std::atof(field.c_str());
+            std::getline(ss, field, ','); r.peakRssKB = (size_t)std::atoll(field.c_str());
+            if (!r.name.empty()) results[r.name] = r;
+        }
+        return results;
+    }
+
+    int compare(const std::vector<BenchmarkResult>& results, std::ostream& out) {
+        FormatGuard guard(out);
+        std::ifstream file(options.baselineFile);
+        if (!file.is_open()) {
+            out << "Cannot read baseline " << options.baselineFile << std::endl;
+            return 1;
+        }
+        std::map<std::string, BenchmarkResult> baseline = load(file);
+
+        int regressions = 0;
+        out << std::endl << "Compared with " << options.baselineFile << " (tolerance "
+            << std::setprecision(0) << options.tolerance * 100 << "%):" << std::endl;
+        for (const BenchmarkResult& r : results) {
+            auto it = baseline.find(r.name);
+            if (it == baseline.end()) {
+                out << "  " << r.name << ": new case" << std::endl;
+                continue;
+            }
+            const BenchmarkResult& base = it->second;
+            double change = base.medianMs > 0 ? (r.medianMs - base.medianMs) / base.medianMs : 0;
+            bool slower = change > options.tolerance && r.medianMs - base.medianMs > options.noiseFloorMs;
+            bool faster = change < -options.tolerance && base.medianMs - r.medianMs > options.noiseFloorMs;
+            out << "  " << r.name << ": " << std::setprecision(3) << base.medianMs << " -> " << r.medianMs
+                << " ms (" << std::showpos << std::setprecision(1) << change * 100 << std::noshowpos << "%)";
+            if (slower) {
+                out << " REGRESSION";
+                regressions++;
+            }
+            else if (faster) {
+                out << " faster";
+            }
+            if (r.nodes != base.nodes) out << ", nodes " << base.nodes << " -> " << r.nodes;
+            out << std::endl;
+        }
+        out << (regressions == 0 ? "No regressions" : std::to_string(regressions) + " regression(s)") << std::endl;
+        return regressions == 0 ? 0 : 1;
+    }
+};
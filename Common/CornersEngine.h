@@ -0,0 +1,154 @@
+﻿#pragma once
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Номер младшего установленного бита (x != 0)
+inline int lowestBit(uint64_t x) {
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanForward64(&bit, x);
+    return (int)bit;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+// Расстановка «Уголков» на доске rows x cols, клетка (row, col) - бит row * stride + col.
+// Белые начинают в прямоугольнике rectRows x rectCols в углу (0, 0), чёрные - в противоположном
+// углу; в цели цвета меняются местами
+struct CornersLayout {
+    uint64_t onBoard = 0;     // клетки доски
+    uint64_t whiteCorner = 0; // старт белых и цель чёрных
+    uint64_t blackCorner = 0; // старт чёрных и цель белых
+
+    CornersLayout(int rows, int cols, int rectRows, int rectCols, int stride) {
+        for (int r = 0; r < rows; r++)
+            for (int c = 0; c < cols; c++)
+                onBoard |= 1ULL << (r * stride + c);
+
+        for (int r = 0; r < rectRows; r++)
+            for (int c = 0; c < rectCols; c++)
+                whiteCorner |= 1ULL << (r * stride + c);
+
+        for (int r = rows - rectRows; r < rows; r++)
+            for (int c = cols - rectCols; c < cols; c++)
+                blackCorner |= 1ULL << (r * stride + c);
+    }
+};
+
+struct CornersRules {
+    bool chainedJumps = false; // прыжок можно продолжать через другие шашки, пока есть куда прыгать
+};
+
+// Генератор ходов «Уголков» на доске Rows x Cols (не больше 64 клеток), клетка (row, col) -
+// бит row * Cols + col. Размеры известны при компиляции, поэтому маски доски и краёв - константы.
+// Шашки, которые могут шагнуть или прыгнуть в каждом направлении, считаются сразу для всей доски.
+// Ходы шашки выдаются по направлениям вверх, вниз, влево, вправо: шаг на пустую соседнюю клетку
+// или прыжок через занятую. С цепочками прыжков затем обходом в глубину по маске посещённых
+// клеток выдаются клетки, куда шашка попадает несколькими прыжками. Ход - пара (откуда, куда),
+// куча не используется
+template <int Rows, int Cols>
+class CornersEngine {
+    static_assert(Rows > 0 && Cols > 0 && Rows * Cols <= 64, "board must fit in 64 bits");
+
+public:
+    static const int STRIDE = Cols;
+
+    CornersLayout layout;
+    CornersRules rules;
+
+    CornersEngine(int rectRows, int rectCols, CornersRules rules_ = CornersRules())
+        : layout(Rows, Cols, rectRows, rectCols, Cols), rules(rules_) {
+    }
+
+    static constexpr uint64_t onBoard() { return Rows * Cols == 64 ? ~0ULL : (1ULL << (Rows * Cols)) - 1; }
+
+    static constexpr uint64_t column(int col) {
+        uint64_t mask = 0;
+        for (int r = 0; r < Rows; r++) mask |= 1ULL << (r * Cols + col);
+        return mask;
+    }
+
+    // Сдвиг множества клеток доски на клетку вверх, вниз, влево или вправо (direction 0-3),
+    // клетки, ушедшие за край доски, отбрасываются
+    static uint64_t shift(uint64_t cells, int direction) {
+        constexpr uint64_t board = onBoard();
+        constexpr uint64_t notFirst = board & ~column(0), notLast = board & ~column(Cols - 1);
+        switch (direction) {
+        case 0: return cells >> Cols;
+        case 1: return (cells << Cols) & board;
+        case 2: return (cells >> 1) & notLast;
+        default: return (cells << 1) & notFirst;
+        }
+    }
+
+    // visit(from, to) для каждого хода позиции; white и black - шашки цветов
+    template <class Visit>
+    void forEachMove(uint64_t white, uint64_t black, Visit&& visit) const {
+        static const int offset[4] = { -Cols, Cols, -1, 1 };
+        const uint64_t occupied = white | black;
+        const uint64_t empty = onBoard() & ~occupied;
+
+        uint64_t stepFrom[4], jumpFrom[4], movable = 0;
+        for (int direction = 0; direction < 4; direction++) {
+            int back = direction ^ 1;
+            uint64_t beforeEmpty = shift(empty, back);
+            stepFrom[direction] = occupied & beforeEmpty;
+            jumpFrom[direction] = occupied & shift(occupied & beforeEmpty, back);
+            movable |= stepFrom[direction] | jumpFrom[direction];
+        }
+
+        for (; movable != 0; movable &= movable - 1) {
+            int from = lowestBit(movable);
+            uint64_t bit = 1ULL << from;
+            uint64_t reached = 0; // клетки, куда шашка уже ходит
+            bool jumps = false;
+            for (int direction = 0; direction < 4; direction++) {
+                int to;
+                if (stepFrom[direction] & bit) to = from + offset[direction];
+                else if (jumpFrom[direction] & bit) to = from + 2 * offset[direction], jumps = true;
+                else continue;
+                reached |= 1ULL << to;
+                visit(from, to);
+            }
+            if (rules.chainedJumps && jumps) addChains(from, occupied & ~bit, reached, visit);
+        }
+    }
+
+private:
+    // Клетки, достижимые цепочкой прыжков с клетки from: обход в глубину явным стеком,
+    // клетки из reached уже выданы и не повторяются
+    template <class Visit>
+    static void addChains(int from, uint64_t occupied, uint64_t reached, Visit& visit) {
+        uint64_t stack[Rows * Cols];
+        int direction[Rows * Cols];
+        uint64_t visited = 1ULL << from;
+        int depth = 0;
+        stack[0] = visited;
+        direction[0] = 0;
+
+        while (depth >= 0) {
+            if (direction[depth] == 4) {
+                depth--;
+                continue;
+            }
+            int d = direction[depth]++;
+            uint64_t over = shift(stack[depth], d) & occupied;
+            uint64_t target = shift(over, d) & ~occupied & ~visited;
+            if (target == 0) continue;
+
+            visited |= target;
+            if (!(reached & target)) {
+                reached |= target;
+                visit(from, lowestBit(target));
+            }
+            depth++;
+            stack[depth] = target;
+            direction[depth] = 0;
+        }
+    }
+};
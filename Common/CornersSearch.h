@@ -0,0 +1,284 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CornersEngine.h"
+#include "FlatStateTable.h"
+#include "IncrementalAssignment.h"
+#include "SearchStats.h"
+
+// Поиск решения «Уголков»: задача на доске Rows x Cols, эвристика на назначениях и A*.
+// Общий код IS_3f и IS_3_antonio
+
+// Позиция: битборды белых и чёрных шашек, клетка (row, col) - бит row * STRIDE + col доски задачи
+struct BoardState {
+    uint64_t white = 0, black = 0;
+
+    bool operator==(const BoardState& other) const { return white == other.white && black == other.black; }
+};
+
+struct BoardHasher {
+    size_t operator()(const BoardState& state) const noexcept { return (size_t)mixStateHash(state.white ^ mixStateHash(state.black)); }
+};
+
+// Ход шашки: номера клеток откуда и куда. Строка хода строится только для итогового пути
+struct Move {
+    uint8_t from = 0, to = 0;
+};
+
+// Задача на доске Rows x Cols с углами rectRows x rectCols: расстановка и ходы - из общего
+// движка «Уголков», правила (цепочки прыжков) задаются в CornersRules
+template <int Rows, int Cols>
+struct CornersTask {
+    static const int STRIDE = Cols;
+
+    CornersEngine<Rows, Cols> engine;
+    BoardState start, goal;
+
+    CornersTask(int rectRows, int rectCols, CornersRules rules = CornersRules()) : engine(rectRows, rectCols, rules) {
+        start.white = goal.black = engine.layout.whiteCorner;
+        start.black = goal.white = engine.layout.blackCorner;
+    }
+
+    std::vector<std::pair<BoardState, Move>> getNeighbors(const BoardState& state) const {
+        std::vector<std::pair<BoardState, Move>> neighbors;
+        engine.forEachMove(state.white, state.black, [&](int from, int to) {
+            Move m;
+            m.from = (uint8_t)from;
+            m.to = (uint8_t)to;
+            neighbors.emplace_back(apply(state, m), m);
+            });
+        return neighbors;
+    }
+
+    bool isGoal(const BoardState& state) const {
+        return state == goal;
+    }
+
+    static BoardState apply(const BoardState& state, Move m) {
+        BoardState nextState = state;
+        uint64_t& pieces = (state.white >> m.from) & 1 ? nextState.white : nextState.black;
+        pieces ^= (1ULL << m.from) | (1ULL << m.to);
+        return nextState;
+    }
+
+    // Ходы пути от начальной позиции в виде "white (r, c) -> (r, c)"
+    std::vector<std::string> formatPath(const std::vector<Move>& moves) const {
+        std::vector<std::string> path;
+        BoardState state = start;
+        for (Move m : moves) {
+            bool white = (state.white >> m.from) & 1;
+            path.push_back(std::string(white ? "white (" : "black (") + std::to_string(m.from / STRIDE) + ", " + std::to_string(m.from % STRIDE) +
+                ") -> (" + std::to_string(m.to / STRIDE) + ", " + std::to_string(m.to % STRIDE) + ")");
+            state = apply(state, m);
+        }
+        return path;
+    }
+};
+
+inline int manhattanDistance(int a, int b, int stride) {
+    return std::abs(a / stride - b / stride) + std::abs(a % stride - b % stride);
+}
+
+// Эвристика A*: для каждого цвета минимальная по назначениям шашек целевым клеткам сумма
+// ceil(manhattan / 2) - шаг или прыжок сдвигает шашку не больше чем на две клетки (с цепочками
+// прыжков оценка уже не допустима, но по-прежнему направляет поиск).
+// Контекст строится один раз на задачу: целевые клетки, для каждой клетки доски строка
+// расстояний до всех целевых клеток и маска ближайших из них. Сумма расстояний до ближайших
+// целевых клеток - нижняя граница назначения; если ближайшие клетки раздаются шашкам без
+// совпадений, граница и есть оптимум, и задача о назначениях не решается. Иначе назначение
+// позиции из setParent решается один раз, а у потомка чинится одним увеличивающим путём
+class CornersHeuristic {
+public:
+    template <class Task>
+    explicit CornersHeuristic(const Task& task) {
+        for (int color = 0; color < 2; color++) {
+            goalCount[color] = cellsOf(color == 0 ? task.goal.white : task.goal.black, goals[color]);
+            for (int square = 0; square < 64; square++) {
+                int nearest = INT_MAX;
+                uint32_t mask = 0;
+                for (int j = 0; j < goalCount[color]; j++) {
+                    int d = (manhattanDistance(square, goals[color][j], Task::STRIDE) + 1) / 2;
+                    distance[color][square][j] = d;
+                    if (d < nearest) nearest = d, mask = 0;
+                    if (d == nearest) mask |= 1u << j;
+                }
+                nearestCost[color][square] = nearest;
+                nearestGoals[color][square] = mask;
+            }
+        }
+    }
+
+    int evaluate(const BoardState& state) {
+        setParent(state);
+        return parentCost[0] + parentCost[1];
+    }
+
+    void setParent(const BoardState& state) {
+        for (int color = 0; color < 2; color++) {
+            cellsOf(color == 0 ? state.white : state.black, pieces[color]);
+            solved[color] = false;
+            bool exact;
+            parentCost[color] = nearestBound(color, pieces[color], exact);
+            if (!exact) solve(color);
+        }
+    }
+
+    // Оценка позиции после хода m из позиции, переданной в setParent
+    int child(const BoardState& parent, Move m) {
+        int color = (parent.white >> m.from) & 1 ? 0 : 1;
+        int cells[IncrementalAssignment::MAX_SIZE];
+        int row = 0;
+        for (int i = 0; i < goalCount[color]; i++) {
+            cells[i] = pieces[color][i];
+            if (cells[i] == m.from) row = i, cells[i] = m.to;
+        }
+        bool exact;
+        int bound = nearestBound(color, cells, exact);
+        if (exact) return bound + parentCost[1 - color];
+        if (!solved[color]) solve(color);
+        return assignment[color].withRow(row, distance[color][m.to]) + parentCost[1 - color];
+    }
+
+private:
+    int goals[2][IncrementalAssignment::MAX_SIZE];
+    int goalCount[2];
+    int distance[2][64][IncrementalAssignment::MAX_SIZE];
+    int nearestCost[2][64];
+    uint32_t nearestGoals[2][64];
+
+    int pieces[2][IncrementalAssignment::MAX_SIZE];
+    IncrementalAssignment assignment[2];
+    bool solved[2] = { false, false };
+    int parentCost[2] = { 0, 0 };
+
+    // Сумма расстояний шашек до ближайших целевых клеток. exact - ближайшие клетки удалось
+    // раздать шашкам по одной, тогда сумма равна оптимальному назначению
+    int nearestBound(int color, const int* cells, bool& exact) const {
+        int sum = 0;
+        uint32_t taken = 0;
+        exact = true;
+        for (int i = 0; i < goalCount[color]; i++) {
+            sum += nearestCost[color][cells[i]];
+            uint32_t free = nearestGoals[color][cells[i]] & ~taken;
+            if (free == 0) exact = false;
+            taken |= free & (0u - free);
+        }
+        return sum;
+    }
+
+    void solve(int color) {
+        const int n = goalCount[color];
+        int cost[IncrementalAssignment::MAX_SIZE * IncrementalAssignment::MAX_SIZE];
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                cost[i * n + j] = distance[color][pieces[color][i]][j];
+        parentCost[color] = assignment[color].solve(cost, n);
+        solved[color] = true;
+    }
+
+    static int cellsOf(uint64_t bits, int* cells) {
+        int n = 0;
+        for (; bits != 0; bits &= bits - 1) cells[n++] = lowestBit(bits);
+        return n;
+    }
+};
+
+template <class Task>
+std::vector<std::string> AStarSolver(const Task& task, SearchStats& stats, int maxExpansions = 1000000) {
+    struct Node {
+        BoardState state;
+        int gCost, hCost;
+        Node(const BoardState& state_, int gCost_, int hCost_)
+            : state(state_), gCost(gCost_), hCost(hCost_) {
+        }
+    };
+
+    struct CompareNodes {
+        bool operator()(const Node& a, const Node& b) const { return a.gCost + a.hCost > b.gCost + b.hCost; }
+    };
+
+    // лучший g, предок и ход для каждого встреченного состояния
+    struct SearchEntry {
+        int gCost = 0;
+        BoardState parent;
+        Move action;
+    };
+
+    // эвристика и генерация ходов с учётом в статистике
+    CornersHeuristic heuristic(task);
+    auto evaluate = [&](const BoardState& state) {
+        PhaseTimer timer(stats.timePhases, stats.heuristicMs);
+        stats.heuristicEvaluations++;
+        return heuristic.evaluate(state);
+    };
+    auto evaluateChild = [&](const BoardState& parent, Move m) {
+        PhaseTimer timer(stats.timePhases, stats.heuristicMs);
+        stats.heuristicEvaluations++;
+        return heuristic.child(parent, m);
+    };
+    auto expand = [&](const BoardState& state) {
+        PhaseTimer timer(stats.timePhases, stats.moveGenMs);
+        auto neighbors = task.getNeighbors(state);
+        stats.generated += neighbors.size();
+        return neighbors;
+    };
+
+    std::priority_queue<Node, std::vector<Node>, CompareNodes> openSet;
+    FlatStateTable<BoardState, SearchEntry, BoardHasher> visited(1 << 16);
+
+    BoardState startState = task.start;
+    openSet.push({ startState, 0, evaluate(startState) });
+    visited.insert(startState);
+
+    int expansions = 0;
+    while (!openSet.empty()) {
+        Node currentNode = openSet.top();
+        openSet.pop();
+        if (expansions++ > maxExpansions) break;
+        stats.expanded++;
+
+        if (task.isGoal(currentNode.state)) {
+            std::vector<Move> path;
+            for (BoardState key = currentNode.state; !(key == startState);) {
+                const SearchEntry* entry = visited.find(key);
+                path.push_back(entry->action);
+                key = entry->parent;
+            }
+            std::reverse(path.begin(), path.end());
+            return task.formatPath(path);
+        }
+
+        auto neighbors = expand(currentNode.state);
+        {
+            PhaseTimer timer(stats.timePhases, stats.heuristicMs);
+            heuristic.setParent(currentNode.state);
+        }
+        for (auto& neighbor : neighbors) {
+            const BoardState& nextState = neighbor.first;
+            int newGCost = currentNode.gCost + 1;
+
+            auto inserted = visited.insert(nextState);
+            SearchEntry& entry = *inserted.first;
+            if (inserted.second || newGCost < entry.gCost) {
+                entry.gCost = newGCost;
+                entry.parent = currentNode.state;
+                entry.action = neighbor.second;
+                openSet.push(Node(nextState, newGCost, evaluateChild(currentNode.state, neighbor.second)));
+                stats.noteOpenSize(openSet.size());
+            }
+            else {
+                stats.duplicates++;
+            }
+        }
+    }
+
+    return {};
+}
@@ -0,0 +1,116 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Хеш-таблица с открытой адресацией (линейное пробирование) для упакованных состояний поиска.
+// Ключи, значения и флаги занятости лежат в плоских массивах: память выделяется только
+// при росте таблицы, поиск ключа - последовательный проход по соседним ячейкам.
+// Удаления нет, поиску оно не нужно.
+
+// Перемешивание битов ключа (финализатор splitmix64), чтобы близкие состояния
+// не попадали в соседние ячейки
+inline uint64_t mixStateHash(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+struct StateHash {
+    size_t operator()(uint64_t key) const noexcept { return (size_t)mixStateHash(key); }
+};
+
+// Пустое значение для таблиц-множеств
+struct NoValue {};
+
+template <class Key, class Value, class Hash = StateHash>
+class FlatStateTable {
+public:
+    explicit FlatStateTable(size_t expected = 1024) { reserve(expected); }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return keys.size(); }
+    bool empty() const { return count == 0; }
+
+    // Ёмкость - степень двойки, заполнение не выше 70%
+    void reserve(size_t expected) {
+        size_t needed = 16;
+        while (needed * 7 < expected * 10) needed <<= 1;
+        if (needed > keys.size()) rehash(needed);
+    }
+
+    Value* find(const Key& key) {
+        size_t slot = findSlot(key);
+        return used[slot] ? &values[slot] : nullptr;
+    }
+
+    const Value* find(const Key& key) const {
+        size_t slot = findSlot(key);
+        return used[slot] ? &values[slot] : nullptr;
+    }
+
+    bool contains(const Key& key) const { return used[findSlot(key)] != 0; }
+
+    // Вставляет ключ, если его ещё нет. Возвращает значение ключа и признак вставки.
+    std::pair<Value*, bool> insert(const Key& key, const Value& value = Value()) {
+        if ((count + 1) * 10 > keys.size() * 7) rehash(keys.size() * 2);
+        size_t slot = findSlot(key);
+        if (used[slot]) return std::make_pair(&values[slot], false);
+        used[slot] = 1;
+        keys[slot] = key;
+        values[slot] = value;
+        count++;
+        return std::make_pair(&values[slot], true);
+    }
+
+    Value& operator[](const Key& key) { return *insert(key).first; }
+
+    void clear() {
+        std::fill(used.begin(), used.end(), (uint8_t)0);
+        count = 0;
+    }
+
+    size_t memoryBytes() const {
+        return keys.capacity() * sizeof(Key) + values.capacity() * sizeof(Value) + used.capacity();
+    }
+
+private:
+    std::vector<Key> keys;
+    std::vector<Value> values;
+    std::vector<uint8_t> used;
+    size_t count = 0;
+    Hash hasher;
+
+    // Ячейка с ключом или первая свободная ячейка на его пути пробирования
+    size_t findSlot(const Key& key) const {
+        size_t mask = keys.size() - 1;
+        size_t slot = hasher(key) & mask;
+        while (used[slot] && !(keys[slot] == key)) slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    void rehash(size_t newCapacity) {
+        std::vector<Key> oldKeys(newCapacity);
+        std::vector<Value> oldValues(newCapacity);
+        std::vector<uint8_t> oldUsed(newCapacity, 0);
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        oldUsed.swap(used);
+        for (size_t i = 0; i < oldUsed.size(); i++) {
+            if (!oldUsed[i]) continue;
+            size_t slot = findSlot(oldKeys[i]);
+            used[slot] = 1;
+            keys[slot] = oldKeys[i];
+            values[slot] = oldValues[i];
+        }
+    }
+};
+
+template <class Key, class Hash = StateHash>
+using FlatStateSet = FlatStateTable<Key, NoValue, Hash>;
@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <climits>
+
+// Задача о назначениях n x n венгерским алгоритмом с сохранением решения: двойственных
+// потенциалов строк и столбцов и паросочетания. Матрица и рабочие массивы - плоские буферы
+// фиксированного размера (MAX_SIZE хватает на шашки одного цвета доски 8x8), куча не используется.
+// withRow() оценивает ту же задачу с другой строкой row: потенциалы остальных строк остаются
+// допустимыми, строка row освобождается, и оптимум восстанавливается одним увеличивающим
+// путём за O(n^2) вместо полного решения за O(n^3). Стоимости неотрицательны.
+class IncrementalAssignment {
+public:
+    static const int MAX_SIZE = 32;
+
+    // Оптимальное назначение для cost[i * n + j], возвращает его стоимость
+    int solve(const int* cost, int n) {
+        size = n;
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                matrix[i * MAX_SIZE + j] = cost[i * n + j];
+        std::fill(u, u + n + 1, 0);
+        std::fill(v, v + n + 1, 0);
+        std::fill(match, match + n + 1, 0);
+        auto at = [this](int i, int j) { return matrix[i * MAX_SIZE + j]; };
+        for (int i = 1; i <= n; i++) augment(i, n, at, u, v, match);
+        return total(n, at, match);
+    }
+
+    // Стоимость оптимального назначения, если строку row (с нуля) заменить на rowCost.
+    // Сохранённое решение не меняется
+    int withRow(int row, const int* rowCost) const {
+        const int n = size;
+        int u2[MAX_SIZE + 1], v2[MAX_SIZE + 1], match2[MAX_SIZE + 1];
+        std::copy(u, u + n + 1, u2);
+        std::copy(v, v + n + 1, v2);
+        std::copy(match, match + n + 1, match2);
+        auto at = [this, row, rowCost](int i, int j) { return i == row ? rowCost[j] : matrix[i * MAX_SIZE + j]; };
+
+        // v <= 0 и стоимости неотрицательны, поэтому с u = 0 строка допустима
+        for (int j = 1; j <= n; j++) {
+            if (match2[j] == row + 1) match2[j] = 0;
+        }
+        u2[row + 1] = 0;
+        augment(row + 1, n, at, u2, v2, match2);
+        return total(n, at, match2);
+    }
+
+    int rows() const { return size; }
+
+private:
+    int size = 0;
+    int matrix[MAX_SIZE * MAX_SIZE];
+    int u[MAX_SIZE + 1] = {}, v[MAX_SIZE + 1] = {};
+    int match[MAX_SIZE + 1] = {}; // match[j] - строка (с единицы), назначенная столбцу j; 0 - свободен
+
+    // Фаза венгерского алгоритма: кратчайший увеличивающий путь от свободной строки row
+    // (с единицы) по редуцированным стоимостям, затем переворот паросочетания вдоль пути
+    template <class Cost>
+    static void augment(int row, int n, const Cost& at, int* u, int* v, int* match) {
+        int minv[MAX_SIZE + 1], way[MAX_SIZE + 1];
+        bool used[MAX_SIZE + 1];
+        std::fill(minv, minv + n + 1, INT_MAX);
+        std::fill(used, used + n + 1, false);
+        match[0] = row;
+        int j0 = 0;
+        do {
+            used[j0] = true;
+            int i0 = match[j0], delta = INT_MAX, j1 = 0;
+            for (int j = 1; j <= n; j++) {
+                if (used[j]) continue;
+                int cur = at(i0 - 1, j - 1) - u[i0] - v[j];
+                if (cur < minv[j]) minv[j] = cur, way[j] = j0;
+                if (minv[j] < delta) delta = minv[j], j1 = j;
+            }
+            for (int j = 0; j <= n; j++) {
+                if (used[j]) { u[match[j]] += delta; v[j] -= delta; }
+                else minv[j] -= delta;
+            }
+            j0 = j1;
+        } while (match[j0] != 0);
+        do {
+            int j1 = way[j0];
+            match[j0] = match[j1];
+            j0 = j1;
+        } while (j0);
+    }
+
+    template <class Cost>
+    static int total(int n, const Cost& at, const int* match) {
+        int sum = 0;
+        for (int j = 1; j <= n; j++) sum += at(match[j] - 1, j - 1);
+        return sum;
+    }
+};
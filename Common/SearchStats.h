@@ -0,0 +1,144 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Общая статистика поиска для всех решателей: одинаковые счётчики во всех программах,
+// чтобы сравнивать запуски между собой и отличать регрессию от шума.
+// Счётчики заполняет сам поиск. Время эвристики и генерации ходов меряется только
+// при включённом timePhases: вызов часов на каждом узле заметно замедляет горячий цикл.
+// Без замера эти поля в toJson() не выводятся.
+
+// Пиковый объём резидентной памяти процесса в байтах (0, если узнать нельзя).
+// В Linux берётся VmHWM, который сбрасывает resetPeakResident()
+inline size_t peakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return (size_t)std::atoll(line.c_str() + 6) * 1024;
+    }
+#endif
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+// Сбрасывает пик резидентной памяти до текущего объёма. false - система этого не умеет
+// (сброс есть только в Linux: запись "5" в /proc/self/clear_refs)
+inline bool resetPeakResident() {
+#ifdef __linux__
+    std::ofstream file("/proc/self/clear_refs");
+    if (!file.is_open()) return false;
+    file << "5";
+    file.close();
+    return !file.fail();
+#else
+    return false;
+#endif
+}
+
+struct SearchStats {
+    long long expanded = 0;             // раскрытые узлы
+    long long generated = 0;            // порождённые потомки
+    long long duplicates = 0;           // потомки и записи открытого списка, отброшенные как уже встреченные
+    long long cutoffs = 0;              // отсечения по порогу f или по границам альфа-бета
+    long long heuristicEvaluations = 0;
+    size_t openPeak = 0;                // пик открытого списка (фронта, стека)
+    bool timePhases = false;
+    double heuristicMs = 0;
+    double moveGenMs = 0;
+    double totalMs = 0;
+    size_t peakRssBytes = 0;            // пик памяти всего процесса на момент finish()
+
+    // Обнуляет счётчики (timePhases сохраняется) и запускает общий таймер
+    void begin() {
+        bool phases = timePhases;
+        *this = SearchStats();
+        timePhases = phases;
+        startTime = std::chrono::steady_clock::now();
+    }
+
+    void finish() {
+        totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        peakRssBytes = peakResidentBytes();
+    }
+
+    void noteOpenSize(size_t size) {
+        if (size > openPeak) openPeak = size;
+    }
+
+    // Добавляет счётчики другого потока или подзадачи
+    void merge(const SearchStats& other) {
+        expanded += other.expanded;
+        generated += other.generated;
+        duplicates += other.duplicates;
+        cutoffs += other.cutoffs;
+        heuristicEvaluations += other.heuristicEvaluations;
+        openPeak = openPeak > other.openPeak ? openPeak : other.openPeak;
+        heuristicMs += other.heuristicMs;
+        moveGenMs += other.moveGenMs;
+    }
+
+    std::string toJson() const {
+        std::ostringstream out;
+        out.setf(std::ios::fixed);
+        out.precision(3);
+        out << "{\"expanded\": " << expanded << ", \"generated\": " << generated
+            << ", \"duplicates\": " << duplicates << ", \"cutoffs\": " << cutoffs
+            << ", \"heuristicEvaluations\": " << heuristicEvaluations << ", \"openPeak\": " << openPeak;
+        if (timePhases) out << ", \"heuristicMs\": " << heuristicMs << ", \"moveGenMs\": " << moveGenMs;
+        out << ", \"totalMs\": " << totalMs << ", \"peakRssKB\": " << peakRssBytes / 1024 << "}";
+        return out.str();
+    }
+
+private:
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+};
+
+// Замер фазы поиска: время жизни объекта прибавляется к счётчику, если замер включён
+class PhaseTimer {
+public:
+    PhaseTimer(bool enabled, double& target) : target(enabled ? &target : nullptr) {
+        if (this->target != nullptr) start = std::chrono::steady_clock::now();
+    }
+
+    ~PhaseTimer() {
+        if (target != nullptr) *target += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    double* target;
+    std::chrono::steady_clock::time_point start;
+};
@@ -10,6 +10,9 @@
 #include <climits>
 #include <random>
 
+#include "../../Common/SearchStats.h"
+#include "../../Common/Benchmark.h"
+
 using namespace std;
 
 // Константы времени
@@ -639,36 +642,58 @@ class MillAI {
 private:
     int maxDepth;
     std::mt19937 rng;
+    SearchStats stats; // статистика последнего findBestMove
+
+    // Оценка позиции с учётом в статистике
+    int evaluate(const MillGame& game, int rootPlayer) {
+        PhaseTimer timer(stats.timePhases, stats.heuristicMs);
+        stats.heuristicEvaluations++;
+        return game.evaluate(rootPlayer);
+    }
 
 public:
     MillAI(int depth = 4) : maxDepth(depth) {
         rng.seed((unsigned)chrono::high_resolution_clock::now().time_since_epoch().count());
     }
 
+    const SearchStats& getLastStats() const { return stats; }
+    void setPhaseTiming(bool value) { stats.timePhases = value; }
+
     // Альфа-бета: rootPlayer игрок от лица которого считаем
     pair<vector<string>, int> alphaBeta(MillGame game, int depth, int alpha, int beta, int player, int rootPlayer,
         chrono::steady_clock::time_point startTime) {
         auto now = chrono::steady_clock::now();
         if (chrono::duration_cast<chrono::milliseconds>(now - startTime).count() > TIME_LIMIT_MS) {
-            return make_pair(vector<string>(), game.evaluate(rootPlayer));
+            return make_pair(vector<string>(), evaluate(game, rootPlayer));
         }
 
         int gameOver = game.checkGameOver();
         if (depth == 0 || gameOver != -1) {
-            int val = game.evaluate(rootPlayer);
+            int val = evaluate(game, rootPlayer);
             return make_pair(vector<string>(), val);
         }
 
-        auto moves = game.getPossibleMoves(player);
-        if (moves.empty()) return make_pair(vector<string>(), game.evaluate(rootPlayer));
+        vector<vector<string>> moves;
+        {
+            PhaseTimer timer(stats.timePhases, stats.moveGenMs);
+            moves = game.getPossibleMoves(player);
+        }
+        if (moves.empty()) return make_pair(vector<string>(), evaluate(game, rootPlayer));
+        stats.expanded++;
+        stats.generated += moves.size();
 
         // Небольшой порядок ходов: оцениваем быстро каждый ход и сортируем
         vector<pair<int, vector<string>>> ordered;
         ordered.reserve(moves.size());
         for (auto m : moves) {
             MillGame ng = game.copy();
-            if (!ng.makeMove(m, player)) continue;
-            int quick = ng.evaluate(rootPlayer);
+            bool legal;
+            {
+                PhaseTimer timer(stats.timePhases, stats.moveGenMs);
+                legal = ng.makeMove(m, player);
+            }
+            if (!legal) continue;
+            int quick = evaluate(ng, rootPlayer);
             ordered.push_back({ quick, m });
         }
 
@@ -705,7 +730,10 @@ public:
                 beta = min(beta, bestValue);
             }
 
-            if (alpha >= beta) break;
+            if (alpha >= beta) {
+                stats.cutoffs++;
+                break;
+            }
 
             now = chrono::steady_clock::now();
             if (chrono::duration_cast<chrono::milliseconds>(now - startTime).count() > TIME_LIMIT_MS) break;
@@ -719,6 +747,7 @@ public:
 
     // Итеративное углубление
     vector<string> findBestMove(MillGame& game, int player) {
+        stats.begin();
         auto start = chrono::steady_clock::now();
         vector<string> best;
         for (int d = 1; d <= maxDepth; d++) {
@@ -727,6 +756,7 @@ public:
             auto now = chrono::steady_clock::now();
             if (chrono::duration_cast<chrono::milliseconds>(now - start).count() > TIME_LIMIT_MS) break;
         }
+        stats.finish();
         return best;
     }
 };
@@ -834,6 +864,7 @@ void runAsBot(int playerColor) {
         if (!moveStr.empty()) moveStr.pop_back();
         cerr << moveStr << endl;
         cout << "My move: " << moveStr << endl;
+        cout << "Search stats: " << ai.getLastStats().toJson() << endl;
         if (!game.makeMove(bestMove, playerColor)) cout << "Failed to apply my move" << endl;
         game.printBoard();
 
@@ -847,7 +878,57 @@ void runAsBot(int playerColor) {
     }
 }
 
+// Позиция середины игры: plies случайных ходов из начальной позиции с фиксированным зерном
+MillGame midgamePosition(unsigned seed, int plies) {
+    mt19937 rng(seed);
+    MillGame position;
+    for (int i = 0; i < plies && position.checkGameOver() == -1; i++) {
+        int player = position.getCurrentPlayer();
+        auto moves = position.getPossibleMoves(player);
+        if (moves.empty()) break;
+        size_t first = rng() % moves.size();
+        for (size_t k = 0; k < moves.size(); k++) {
+            const auto& move = moves[(first + k) % moves.size()];
+            if (position.copy().makeMove(move, player)) {
+                position.makeMove(move, player);
+                break;
+            }
+        }
+    }
+    return position;
+}
+
+// Замеры альфа-бета с глубиной бота (5) на позициях фазы движения (расстановка занимает 18 ходов)
+int runBenchmarks(const BenchmarkOptions& options) {
+    const pair<unsigned, int> positions[] = { {1, 20}, {2, 24}, {3, 28}, {4, 32} };
+
+    BenchmarkSuite suite(options);
+    for (const auto& p : positions) {
+        MillGame position = midgamePosition(p.first, p.second);
+        string name = "alphabeta-d5/seed" + to_string(p.first) + "-ply" + to_string(p.second);
+        suite.add(name, [position]() {
+            MillAI benchAi(5);
+            MillGame current = position.copy();
+            benchAi.findBestMove(current, current.getCurrentPlayer());
+            return benchAi.getLastStats().expanded;
+            });
+    }
+    return suite.run(cout);
+}
+
+// IS4v2 --bench [--warmup N] [--reps N] [--filter S] [--save file] [--baseline file] [--tolerance X]
+// IS4v2 [0|1] [--phase-timing] - бот за цвет 0/1 или игра с человеком; --phase-timing - время
+// оценки и генерации ходов в статистике поиска
 int main(int argc, char* argv[]) {
+    BenchmarkOptions benchOptions;
+    if (parseBenchmarkArgs(argc, argv, benchOptions)) {
+        return runBenchmarks(benchOptions);
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--phase-timing") ai.setPhaseTiming(true);
+    }
+
     for (int i = 1; i < argc; i++) {
         string arg = argv[i];
         if (arg == "0" || arg == "1") {
@@ -10,11 +10,40 @@
 #include <vector>
 #include <queue>
 #include <chrono>
+#include <algorithm>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <climits>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../../Common/FlatStateTable.h"
+#include "../../Common/Benchmark.h"
 
 using namespace std;
 using namespace std::chrono;
 
+// Статистика последнего запуска task1-task4 и обобщённых движков (expanded - раскрытые числа).
+// Сигнатура vector<int>(int, int) общая для print и замеров, поэтому счётчик отдаётся здесь
+static SearchStats lastSearch;
+
 vector<int> task1(int a, int b) {
+	lastSearch = SearchStats();
 	queue<int> q;
 	vector<int> result(b + 1, -1);
 	vector<bool> visited(b + 1);
@@ -24,6 +53,7 @@ vector<int> task1(int a, int b) {
 		int cur = q.front();
 		q.pop();
 		if (cur == b) break;
+		lastSearch.expanded++;
 		if (cur + 3 <= b && !visited[cur + 3]) {
 			visited[cur + 3] = true;
 			q.push(cur + 3);
@@ -38,11 +68,8 @@ vector<int> task1(int a, int b) {
 	return result;
 }
 
-void print(int a, int b, vector<int>(*func)(int, int)) {
-	cout << a << " -> " << b << endl;
-	auto start = steady_clock::now();
-	vector<int> vec = func(a, b);
-	auto end = steady_clock::now();
+// Число операций пути a -> b по массиву предков, 0 - пути нет
+int pathLength(const vector<int>& vec, int a, int b) {
 	int count = 0;
 	int cur = b;
 	if (vec[b] != -1) {
@@ -55,6 +82,15 @@ void print(int a, int b, vector<int>(*func)(int, int)) {
 			count++;
 		}
 	}
+	return count;
+}
+
+void print(int a, int b, vector<int>(*func)(int, int)) {
+	cout << a << " -> " << b << endl;
+	auto start = steady_clock::now();
+	vector<int> vec = func(a, b);
+	auto end = steady_clock::now();
+	int count = pathLength(vec, a, b);
 	auto ms = duration_cast<microseconds>(end - start).count();
 	cout << "count operation=" << count << endl;
 	cout << "Time: " << ms / 1000.0 << " ms" << endl;
@@ -69,6 +105,7 @@ vector<int> task2(int a, int b) {
 	vector<int> result(n, -1);
 	vector<bool> visited(n, false);
 	queue<int> q;
+	lastSearch = SearchStats();
 
 	q.push(a);
 	visited[a] = true;
@@ -80,6 +117,7 @@ vector<int> task2(int a, int b) {
 		int sw2 = cur * 2;
 		int sw3 = cur - 2;
 		if (cur == b) break;
+		lastSearch.expanded++;
 		if (inRange(sw1) && !visited[sw1]) {
 			visited[sw1] = true;
 			q.push(sw1);
@@ -100,6 +138,7 @@ vector<int> task2(int a, int b) {
 }
 
 vector<int> task3(int a, int b) {
+	lastSearch = SearchStats();
 	queue<int> q;
 	vector<int>result(b + 1, -1);
 	vector<bool>visited(b + 1);
@@ -108,6 +147,7 @@ vector<int> task3(int a, int b) {
 	while (!q.empty()) {
 		int current = q.front();
 		q.pop();
+		lastSearch.expanded++;
 		if (current - 3 >= 0 && !visited[current - 3]) {
 			q.push(current - 3);
 			visited[current - 3] = true;
@@ -132,79 +172,895 @@ vector<int> task3(int a, int b) {
 	return realRes;
 }
 
+// Двунаправленный поиск. Раскрывается меньший из фронтов; слой, где стороны впервые
+// встретились, раскрывается до конца, и из всех встреч слоя берётся кратчайший путь (ранний
+// выход на первой встрече мог дать путь длиннее кратчайшего). Прямая сторона хранит родителей
+// в массиве, обратная от b затрагивает мало чисел и хранится в хеш-таблице «число -> следующее
+// число к b». Числа пути не меньше a, поэтому обратная сторона ниже a не спускается.
 vector<int> task4(int a, int b) {
-	queue<int> q1;
-	q1.push(a);
-	vector<int>result1(b + 1, -1);
-	vector<bool>visited1(b + 1);
+	lastSearch = SearchStats();
+	vector<int> result(b + 1, -1);
+	if (a > b) return result;
+	vector<bool> visited1(b + 1);
+	FlatStateTable<int, int> next2;
 	visited1[a] = true;
+	next2.insert(b, b);
 
-	queue<int> q2;
-	q2.push(b);
-	vector<int>result2(b + 1, -1);
-	vector<bool>visited2(b + 1);
-	visited2[b] = true;
-
-	int middle = -1;
-
-	while (!q1.empty() && !q2.empty() && middle == -1) {
-		int qs = q1.size();
-		while (qs-- && middle == -1) {
-			int cur1 = q1.front();
-			q1.pop();
-			for (int nx : {cur1 + 3, cur1 * 2}) {
-				if (nx <= b && !visited1[nx]) {
+	auto depth1 = [&](int x) {
+		int depth = 0;
+		for (; x != a; x = result[x]) depth++;
+		return depth;
+	};
+	auto depth2 = [&](int x) {
+		int depth = 0;
+		for (; x != b; x = *next2.find(x)) depth++;
+		return depth;
+	};
+
+	vector<int> q1(1, a), q2(1, b), layer;
+	int level1 = 0, level2 = 0;
+	int middle = a == b ? a : -1;
+	int best = INT_MAX;
+	while (middle == -1 && !q1.empty() && !q2.empty()) {
+		layer.clear();
+		if (q1.size() <= q2.size()) {
+			lastSearch.expanded += q1.size();
+			for (int cur1 : q1) {
+				for (int nx : {cur1 + 3, cur1 * 2}) {
+					if (nx > b || visited1[nx]) continue;
 					visited1[nx] = true;
-					result1[nx] = cur1;
-					q1.push(nx);
-					if (visited2[nx]) { middle = nx; break; }
+					result[nx] = cur1;
+					layer.push_back(nx);
+					if (next2.contains(nx) && level1 + 1 + depth2(nx) < best) {
+						best = level1 + 1 + depth2(nx);
+						middle = nx;
+					}
 				}
 			}
+			q1.swap(layer);
+			level1++;
+		}
+		else {
+			lastSearch.expanded += q2.size();
+			for (int cur2 : q2) {
+				for (int nx : {cur2 - 3, (cur2 % 2 == 0 ? cur2 / 2 : -1)}) {
+					if (nx < a || !next2.insert(nx, cur2).second) continue;
+					layer.push_back(nx);
+					if (visited1[nx] && level2 + 1 + depth1(nx) < best) {
+						best = level2 + 1 + depth1(nx);
+						middle = nx;
+					}
+				}
+			}
+			q2.swap(layer);
+			level2++;
+		}
+	}
+
+	vector<int> full;
+	if (middle != -1) {
+		for (int cur = middle; cur != a; cur = result[cur]) full.push_back(cur);
+		full.push_back(a);
+		reverse(full.begin(), full.end());
+		for (int cur = middle; cur != b; cur = *next2.find(cur)) full.push_back(*next2.find(cur));
+	}
+
+	fill(result.begin(), result.end(), -1);
+	for (size_t i = 1; i < full.size(); i++) result[full[i]] = full[i - 1];
+	return result;
+}
+
+// ===== Обобщённый поиск по набору операций =====
+// Операция - тип с параметром времени компиляции: apply даёт результат операции, invert - число,
+// из которого операция даёт y (для обратного поиска). Набор раскрывается в последовательность
+// вызовов при компиляции, поэтому ядра для фиксированного набора не уступают task1-task4.
+// Все варианты возвращают массив родителей в прямом направлении, как задачи выше.
+template <int K>
+struct Add {
+	static constexpr bool nonDecreasing() { return K >= 0; }
+	static constexpr int factor() { return 1; }
+	static bool apply(long long x, long long& y) { y = x + K; return true; }
+	static bool invert(long long y, long long& x) { x = y - K; return true; }
+};
+
+template <int M>
+struct Mul {
+	static constexpr bool nonDecreasing() { return M >= 1; }
+	static constexpr int factor() { return M; }
+	static bool apply(long long x, long long& y) { y = x * M; return true; }
+	static bool invert(long long y, long long& x) {
+		if (y % M != 0) return false;
+		x = y / M;
+		return true;
+	}
+};
+
+template <int K>
+struct Sub {
+	static constexpr bool nonDecreasing() { return K <= 0; }
+	static constexpr int factor() { return 1; }
+	static bool apply(long long x, long long& y) { y = x - K; return true; }
+	static bool invert(long long y, long long& x) { x = y + K; return true; }
+};
+
+constexpr bool allOf() { return true; }
+template <class... Rest>
+constexpr bool allOf(bool first, Rest... rest) { return first && allOf(rest...); }
+
+constexpr int maxOf() { return 1; }
+template <class... Rest>
+constexpr int maxOf(int first, Rest... rest) { return first > maxOf(rest...) ? first : maxOf(rest...); }
+
+struct SearchRange {
+	long long lower, limit;
+	bool contains(long long x) const { return x >= lower && x <= limit; }
+};
+
+template <class... Ops>
+struct OperationSet {
+	static constexpr bool nonDecreasing() { return allOf(Ops::nonDecreasing()...); }
+
+	// Без уменьшающих операций числа пути лежат в [a, b], иначе границы как в task2 (с учётом a > b)
+	static SearchRange range(long long a, long long b) {
+		if (nonDecreasing()) return { a, b };
+		return { 0, max(a, b) * maxOf(Ops::factor()...) + 16 };
+	}
+
+	// visit для каждого числа, получаемого из x одной операцией, в порядке операций набора
+	template <class Visit>
+	static void forEachNext(long long x, Visit&& visit) {
+		long long y;
+		int expand[] = { 0, (Ops::apply(x, y) ? (visit(y), 0) : 0)... };
+		(void)expand;
+	}
+
+	// visit для каждого числа, из которого x получается одной операцией
+	template <class Visit>
+	static void forEachPrevious(long long x, Visit&& visit) {
+		long long y;
+		int expand[] = { 0, (Ops::invert(x, y) ? (visit(y), 0) : 0)... };
+		(void)expand;
+	}
+};
+
+using Task1Ops = OperationSet<Add<3>, Mul<2>>;
+using Task2Ops = OperationSet<Add<3>, Mul<2>, Sub<2>>;
+
+// Массив родителей только для чисел пути
+static vector<int> pathParents(const vector<int>& path, size_t n) {
+	vector<int> parents(n, -1);
+	for (size_t i = 1; i < path.size(); i++) parents[path[i]] = path[i - 1];
+	return parents;
+}
+
+template <class Set>
+vector<int> forwardSearch(int a, int b) {
+	lastSearch = SearchStats();
+	const SearchRange range = Set::range(a, b);
+	vector<int> parent((size_t)range.limit + 1, -1);
+	if (!range.contains(a) || !range.contains(b)) return parent;
+	vector<bool> visited(parent.size());
+	vector<int> front(1, a), layer;
+	visited[a] = true;
+	while (!front.empty() && !visited[b]) {
+		layer.clear();
+		for (size_t i = 0; i < front.size() && !visited[b]; i++) {
+			int cur = front[i];
+			lastSearch.expanded++;
+			Set::forEachNext(cur, [&](long long nx) {
+				if (range.contains(nx) && !visited[(size_t)nx]) {
+					visited[(size_t)nx] = true;
+					parent[(size_t)nx] = cur;
+					layer.push_back((int)nx);
+				}
+				});
 		}
+		front.swap(layer);
+	}
+	return parent;
+}
 
-		qs = q2.size();
-		while (qs-- && middle == -1) {
-			int cur2 = q2.front(); 
-			q2.pop();
-			for (int nx : {cur2 - 3, (cur2 % 2 == 0 ? cur2 / 2 : -1)}) {
-				if (nx >= 0 && !visited2[nx]) {
-					visited2[nx] = true;
-					result2[nx] = cur2;
-					q2.push(nx);
-					if (visited1[nx]) { middle = nx; break; }
+template <class Set>
+vector<int> backwardSearch(int a, int b) {
+	lastSearch = SearchStats();
+	const SearchRange range = Set::range(a, b);
+	const size_t n = (size_t)range.limit + 1;
+	if (!range.contains(a) || !range.contains(b)) return vector<int>(n, -1);
+	vector<int> next(n, -1); // следующее число на пути к b
+	vector<bool> visited(n);
+	vector<int> front(1, b), layer;
+	visited[b] = true;
+	next[b] = b;
+	while (!front.empty() && !visited[a]) {
+		layer.clear();
+		for (size_t i = 0; i < front.size() && !visited[a]; i++) {
+			int cur = front[i];
+			lastSearch.expanded++;
+			Set::forEachPrevious(cur, [&](long long px) {
+				if (range.contains(px) && !visited[(size_t)px]) {
+					visited[(size_t)px] = true;
+					next[(size_t)px] = cur;
+					layer.push_back((int)px);
 				}
+				});
+		}
+		front.swap(layer);
+	}
+	vector<int> path;
+	if (next[a] != -1) {
+		for (int cur = a; cur != b; cur = next[cur]) path.push_back(cur);
+		path.push_back(b);
+	}
+	return pathParents(path, n);
+}
+
+// Раскрывается меньший из фронтов. Слой с первой встречей раскрывается до конца,
+// из всех встреч слоя выбирается кратчайший путь
+template <class Set>
+vector<int> bidirectionalSearch(int a, int b) {
+	lastSearch = SearchStats();
+	const SearchRange range = Set::range(a, b);
+	const size_t n = (size_t)range.limit + 1;
+	if (!range.contains(a) || !range.contains(b)) return vector<int>(n, -1);
+	vector<int> parent(n, -1), next(n, -1);
+	parent[a] = a;
+	next[b] = b;
+	auto depthOf = [](const vector<int>& links, int x) {
+		int depth = 0;
+		for (; links[x] != x; x = links[x]) depth++;
+		return depth;
+	};
+
+	vector<int> front(1, a), back(1, b), layer;
+	int depthFront = 0, depthBack = 0;
+	int meet = a == b ? a : -1;
+	int best = INT_MAX;
+	while (meet == -1 && !front.empty() && !back.empty()) {
+		layer.clear();
+		if (front.size() <= back.size()) {
+			lastSearch.expanded += front.size();
+			for (int cur : front) {
+				Set::forEachNext(cur, [&](long long nx) {
+					if (!range.contains(nx) || parent[(size_t)nx] != -1) return;
+					parent[(size_t)nx] = cur;
+					layer.push_back((int)nx);
+					if (next[(size_t)nx] != -1 && depthFront + 1 + depthOf(next, (int)nx) < best) {
+						best = depthFront + 1 + depthOf(next, (int)nx);
+						meet = (int)nx;
+					}
+					});
+			}
+			front.swap(layer);
+			depthFront++;
+		}
+		else {
+			lastSearch.expanded += back.size();
+			for (int cur : back) {
+				Set::forEachPrevious(cur, [&](long long px) {
+					if (!range.contains(px) || next[(size_t)px] != -1) return;
+					next[(size_t)px] = cur;
+					layer.push_back((int)px);
+					if (parent[(size_t)px] != -1 && depthBack + 1 + depthOf(parent, (int)px) < best) {
+						best = depthBack + 1 + depthOf(parent, (int)px);
+						meet = (int)px;
+					}
+					});
 			}
+			back.swap(layer);
+			depthBack++;
 		}
 	}
 
-	if (middle == -1) return vector<int>(b + 1, -1);
+	vector<int> path;
+	if (meet != -1) {
+		for (int cur = meet; cur != a; cur = parent[cur]) path.push_back(cur);
+		path.push_back(a);
+		reverse(path.begin(), path.end());
+		for (int cur = meet; cur != b; cur = next[cur]) path.push_back(next[cur]);
+	}
+	return pathParents(path, n);
+}
+
+// ===== Параллельный поиск в ширину по уровням =====
+// Уровень раскрывается всеми потоками: фронт делится на равные части, посещённые числа
+// отмечаются атомарным fetch_or в битовой карте, каждый поток собирает свою часть следующего
+// фронта, затем части склеиваются. Когда фронт становится плотным, уровень раскрывается снизу
+// вверх: каждое непосещённое число ищет предка во фронте. Тогда поток владеет своими словами
+// карты целиком и пишет их без атомарных операций. Уровни синхронны, поэтому длины путей
+// совпадают с task1, сами пути могут отличаться выбором родителя.
+
+// work(worker, begin, end) для равных частей [0, count)
+template <class Work>
+static void parallelFor(int threads, size_t count, Work&& work) {
+	vector<thread> workers;
+	size_t step = (count + threads - 1) / threads;
+	for (int w = 0; w < threads; w++) {
+		size_t begin = min(count, w * step), end = min(count, begin + step);
+		if (begin == end) break;
+		workers.emplace_back([&work, w, begin, end] { work(w, begin, end); });
+	}
+	for (thread& worker : workers) worker.join();
+}
+
+template <class Set>
+vector<int> parallelSearch(int a, int b, int threads) {
+	lastSearch = SearchStats();
+	const SearchRange range = Set::range(a, b);
+	const size_t n = (size_t)range.limit + 1;
+	vector<int> parent(n, -1);
+	if (!range.contains(a) || !range.contains(b)) return parent;
+	if (threads <= 0) threads = max(1, (int)thread::hardware_concurrency());
 
-	vector<int>left;
-	for (int cur = middle; cur != -1; cur = result1[cur]) left.push_back(cur);
-	//for (int i = 0; i < left.size(); i++) {
-	//	cout << left[i] << " - ";
-	//}
-	reverse(left.begin(), left.end());
+	const size_t words = (n + 63) / 64;
+	unique_ptr<atomic<uint64_t>[]> visited(new atomic<uint64_t>[words]);
+	parallelFor(threads, words, [&](int, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) visited[i].store(0, memory_order_relaxed);
+		});
+	auto isVisited = [&](long long x) { return (visited[(size_t)x >> 6].load(memory_order_relaxed) >> (x & 63)) & 1; };
+	vector<uint64_t> frontBits; // фронт снизу вверх
+	vector<vector<int>> parts(threads);
 
-	if (left.empty() || left.front() != a) return vector<int>(b + 1, -1);
+	vector<int> front(1, a);
+	visited[(size_t)a >> 6].fetch_or(1ULL << (a & 63));
+	size_t unvisited = (size_t)(range.limit - range.lower);
+	bool bottomUp = false;
+	while (!front.empty() && !isVisited(b)) {
+		// переключение как у Бимера. Проверка числа снизу вверх примерно в 6 раз дешевле
+		// раскрытия числа фронта сверху вниз (атомарная запись в случайное место карты)
+		if (!bottomUp && front.size() * 6 > unvisited) bottomUp = true;
+		else if (bottomUp && front.size() * 24 < n) bottomUp = false;
+		lastSearch.expanded += front.size();
 
-	vector<int>right;
-	for (int cur = result2[middle]; cur != -1; cur = result2[cur]) right.push_back(cur);
+		if (!bottomUp) {
+			parallelFor(threads, front.size(), [&](int w, size_t begin, size_t end) {
+				vector<int>& out = parts[w];
+				for (size_t i = begin; i < end; i++) {
+					int cur = front[i];
+					Set::forEachNext(cur, [&](long long nx) {
+						if (!range.contains(nx)) return;
+						// обычное чтение отсекает повторы без атомарной записи, один поток пишет без fetch_or
+						atomic<uint64_t>& word = visited[(size_t)nx >> 6];
+						uint64_t bit = 1ULL << (nx & 63);
+						uint64_t seen = word.load(memory_order_relaxed);
+						if (seen & bit) return;
+						if (threads == 1) word.store(seen | bit, memory_order_relaxed);
+						else if (word.fetch_or(bit, memory_order_relaxed) & bit) return;
+						parent[(size_t)nx] = cur;
+						out.push_back((int)nx);
+						});
+				}
+				});
+		}
+		else {
+			frontBits.assign(words, 0);
+			for (int x : front) frontBits[(size_t)x >> 6] |= 1ULL << (x & 63);
+			parallelFor(threads, words, [&](int w, size_t begin, size_t end) {
+				vector<int>& out = parts[w];
+				for (size_t word = begin; word < end; word++) {
+					uint64_t seen = visited[word].load(memory_order_relaxed);
+					if (seen == ~0ULL) continue;
+					uint64_t added = 0;
+					for (int j = 0; j < 64; j++) {
+						long long x = (long long)(word * 64 + j);
+						if ((seen >> j) & 1 || !range.contains(x)) continue;
+						long long found = -1;
+						Set::forEachPrevious(x, [&](long long p) {
+							if (found == -1 && range.contains(p) && (frontBits[(size_t)p >> 6] >> (p & 63)) & 1) found = p;
+							});
+						if (found == -1) continue;
+						parent[(size_t)x] = (int)found;
+						added |= 1ULL << j;
+						out.push_back((int)x);
+					}
+					if (added) visited[word].store(seen | added, memory_order_relaxed);
+				}
+				});
+		}
 
-	vector<int> full = left;
-	full.insert(full.end(), right.begin(), right.end());
+		front.clear();
+		for (vector<int>& part : parts) {
+			front.insert(front.end(), part.begin(), part.end());
+			part.clear();
+		}
+		unvisited -= front.size();
+	}
+	return parent;
+}
+
+template <class Set>
+vector<int> parallelSearchAll(int a, int b) {
+	return parallelSearch<Set>(a, b, 0);
+}
 
-	vector<int> parentDown(b + 1, -1);
-	for (int i = 1; i < full.size(); i++) {
-		int prev = full[i - 1];
-		int cur = full[i];
-		parentDown[cur] = prev;
+// ===== Экономный по памяти движок =====
+// Поиск в ширину идёт обратными операциями от b к a и хранит только текущий фронт и битовую
+// карту посещённых чисел, блоки карты выделяются при первом обращении. Прямой поиск от малого a
+// заполняет почти все числа до b, обратный фронт держится у чисел b / 2^k и остаётся узким.
+// Родители не хранятся: повторный проход отмечает у каждого числа фронта его предка на середине
+// пути (опорное число), после чего две половины пути решаются рекурсивно. Память определяется
+// фронтом и затронутыми блоками карты, а не b, поэтому цели до 1e9 не требуют массивов на b + 1.
+
+// Битовая карта чисел [0, limit] из блоков по 2^16 бит
+class ChunkedBitmap {
+public:
+	explicit ChunkedBitmap(long long limit) : chunks((size_t)(limit >> CHUNK_SHIFT) + 1) {}
+
+	// Отмечает x, возвращает true, если x ещё не был отмечен
+	bool insert(long long x) {
+		unique_ptr<uint64_t[]>& chunk = chunks[(size_t)(x >> CHUNK_SHIFT)];
+		if (!chunk) {
+			chunk.reset(new uint64_t[CHUNK_WORDS]());
+			allocated++;
+		}
+		uint64_t& word = chunk[(x & CHUNK_MASK) >> 6];
+		uint64_t bit = 1ULL << (x & 63);
+		if (word & bit) return false;
+		word |= bit;
+		return true;
 	}
-	return parentDown;
+
+	size_t memoryBytes() const { return chunks.size() * sizeof(chunks[0]) + allocated * CHUNK_WORDS * sizeof(uint64_t); }
+
+private:
+	static const int CHUNK_SHIFT = 16;
+	static const long long CHUNK_MASK = (1LL << CHUNK_SHIFT) - 1;
+	static const size_t CHUNK_WORDS = (1 << CHUNK_SHIFT) / 64;
+
+	vector<unique_ptr<uint64_t[]>> chunks;
+	size_t allocated = 0;
+};
+
+struct NumberOps {
+	bool subtract2;  // операция «вычесть 2» (задача 2)
+	long long lower; // числа вне [lower, limit] не рассматриваются
+	long long limit;
+};
+
+struct LeanSearchInfo {
+	SearchStats stats;
+	size_t peakBytes = 0; // пик памяти одного прохода: карта и два фронта
+};
+
+// Числа, из которых x получается одной операцией «+3», «*2» или «-2»
+static int previousNumbers(long long x, const NumberOps& ops, long long out[3]) {
+	int n = 0;
+	if (x - 3 >= ops.lower) out[n++] = x - 3;
+	if (x % 2 == 0 && x / 2 >= ops.lower) out[n++] = x / 2;
+	if (ops.subtract2 && x + 2 <= ops.limit) out[n++] = x + 2;
+	return n;
 }
 
-int main()
+// Обратный поиск в ширину от b до a. Возвращает длину кратчайшего пути или -1. Если
+// relayLevel >= 0, в relay записывается число пути на расстоянии relayLevel от b
+static int frontierSearch(long long b, long long a, const NumberOps& ops, int relayLevel, long long& relay, LeanSearchInfo& info) {
+	ChunkedBitmap visited(ops.limit);
+	vector<pair<long long, long long>> frontier(1, { b, b }), next; // число и его опорное число
+	visited.insert(b);
+
+	for (int depth = 0; !frontier.empty(); depth++) {
+		info.stats.noteOpenSize(frontier.size());
+		if (depth == relayLevel) {
+			for (auto& entry : frontier) entry.second = entry.first;
+		}
+
+		next.clear();
+		for (const auto& entry : frontier) {
+			info.stats.expanded++;
+			if (entry.first == a) {
+				relay = entry.second;
+				return depth;
+			}
+			long long children[3];
+			int count = previousNumbers(entry.first, ops, children);
+			info.stats.generated += count;
+			for (int i = 0; i < count; i++) {
+				if (visited.insert(children[i])) next.push_back({ children[i], entry.second });
+				else info.stats.duplicates++;
+			}
+		}
+		size_t bytes = visited.memoryBytes() + (frontier.capacity() + next.capacity()) * sizeof(frontier[0]);
+		info.peakBytes = max(info.peakBytes, bytes);
+		frontier.swap(next);
+	}
+	return -1;
+}
+
+// Дописывает в path числа пути от b (не включая b) назад до a длины depth
+static void relayPath(long long b, long long a, int depth, const NumberOps& ops, vector<long long>& path, LeanSearchInfo& info) {
+	if (depth == 0) return;
+	if (depth == 1) {
+		path.push_back(a);
+		return;
+	}
+	int middle = depth / 2;
+	long long relay = b;
+	frontierSearch(b, a, ops, middle, relay, info);
+	relayPath(b, relay, middle, ops, path, info);
+	relayPath(relay, a, depth - middle, ops, path, info);
+}
+
+// Кратчайшая цепочка чисел от a до b (пустая, если пути нет). Границы как в task1 и task2:
+// без «-2» числа пути не выходят из [a, b], с «-2» - из [0, 2b + 16]
+vector<long long> leanSearch(long long a, long long b, bool subtract2, LeanSearchInfo& info) {
+	NumberOps ops = { subtract2, subtract2 ? 0 : a, subtract2 ? b * 2 + 16 : b };
+	if (a < ops.lower || a > ops.limit || b < ops.lower) return {};
+	long long relay = b;
+	int depth = frontierSearch(b, a, ops, -1, relay, info);
+	if (depth < 0) return {};
+	vector<long long> path(1, b);
+	relayPath(b, a, depth, ops, path, info);
+	reverse(path.begin(), path.end());
+	return path;
+}
+
+void printLean(long long a, long long b, bool subtract2) {
+	cout << a << " -> " << b << (subtract2 ? " (+3, *2, -2)" : " (+3, *2)") << endl;
+	LeanSearchInfo info;
+	auto start = steady_clock::now();
+	vector<long long> path = leanSearch(a, b, subtract2, info);
+	auto end = steady_clock::now();
+	auto ms = duration_cast<microseconds>(end - start).count();
+	cout << "count operation=" << (path.empty() ? 0 : path.size() - 1) << endl;
+	cout << "Time: " << ms / 1000.0 << " ms; search memory: " << info.peakBytes / 1024 << " KB" << endl;
+}
+
+// ===== Пакетные запросы с общим деревом поиска =====
+// Для одного a дерево кратчайших путей (задача 1) строится один раз до наибольшего
+// запрошенного b, каждый запрос - проход по родителям от b к a. Операции «+3» и «*2» не
+// уменьшают числа, поэтому дерево до limit верно для любого b <= limit. Дерево можно
+// сохранить в файл и затем отображать его в память без построения.
+class BfsTreeCache {
+public:
+	BfsTreeCache() = default;
+	BfsTreeCache(const BfsTreeCache&) = delete;
+	BfsTreeCache& operator=(const BfsTreeCache&) = delete;
+	~BfsTreeCache() { unload(); }
+
+	bool covers(int a, int b) const { return parents != nullptr && a == startValue && b >= 0 && b <= maxValue; }
+	int limit() const { return maxValue; }
+
+	// Поиск в ширину от a по всем числам [0, limit]
+	void build(int a, int limit) {
+		unload();
+		ownedParents.assign((size_t)limit + 1, -1);
+		// по слоям: в памяти только текущий и следующий слой, а не все достигнутые числа
+		vector<int32_t> layer(1, a), next;
+		ownedParents[a] = a;
+		while (!layer.empty()) {
+			next.clear();
+			for (long long cur : layer) {
+				for (long long nx : { cur + 3, cur * 2 }) {
+					if (nx <= limit && ownedParents[(size_t)nx] == -1) {
+						ownedParents[(size_t)nx] = (int32_t)cur;
+						next.push_back((int32_t)nx);
+					}
+				}
+			}
+			layer.swap(next);
+		}
+		parents = ownedParents.data();
+		startValue = a;
+		maxValue = limit;
+	}
+
+	// Кратчайшая цепочка от a до b, пустая, если b недостижимо
+	vector<int> pathTo(int b) const {
+		vector<int> path;
+		if (parents[b] == -1) return path;
+		for (int cur = b; cur != startValue; cur = parents[cur]) path.push_back(cur);
+		path.push_back(startValue);
+		reverse(path.begin(), path.end());
+		return path;
+	}
+
+	bool save(const string& filename) const {
+		if (parents == nullptr) return false;
+		ofstream file(filename, ios::binary);
+		if (!file.is_open()) {
+			cerr << "Cannot open file " << filename << endl;
+			return false;
+		}
+		FileHeader header = makeHeader(startValue, maxValue);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(parents), ((size_t)maxValue + 1) * sizeof(int32_t));
+		return (bool)file;
+	}
+
+	// Отображение файла в память без копирования
+	bool load(const string& filename) {
+		unload();
+#ifdef _WIN32
+		fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) || (size_t)fileSize.QuadPart < sizeof(FileHeader)) {
+			unload();
+			return false;
+		}
+		mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mappingHandle == nullptr) {
+			unload();
+			return false;
+		}
+		mappedView = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		if (mappedView == nullptr) {
+			unload();
+			return false;
+		}
+		mappedSize = (size_t)fileSize.QuadPart;
+#else
+		int fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat info;
+		if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(FileHeader)) {
+			close(fd);
+			return false;
+		}
+		void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (view == MAP_FAILED) return false;
+		mappedView = view;
+		mappedSize = (size_t)info.st_size;
+#endif
+		FileHeader header;
+		memcpy(&header, mappedView, sizeof(header));
+		FileHeader expected = makeHeader(header.start, header.limit);
+		if (memcmp(&header, &expected, sizeof(header)) != 0 || header.limit < 0
+			|| mappedSize != sizeof(FileHeader) + ((size_t)header.limit + 1) * sizeof(int32_t)) {
+			cerr << "Tree file " << filename << " has a different layout" << endl;
+			unload();
+			return false;
+		}
+		parents = reinterpret_cast<const int32_t*>(static_cast<const char*>(mappedView) + sizeof(FileHeader));
+		startValue = header.start;
+		maxValue = header.limit;
+		return true;
+	}
+
+	void unload() {
+		parents = nullptr;
+		startValue = -1;
+		maxValue = -1;
+		vector<int32_t>().swap(ownedParents);
+#ifdef _WIN32
+		if (mappedView != nullptr) UnmapViewOfFile(mappedView);
+		if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+		if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+		mappingHandle = nullptr;
+		fileHandle = INVALID_HANDLE_VALUE;
+#else
+		if (mappedView != nullptr) munmap(mappedView, mappedSize);
+#endif
+		mappedView = nullptr;
+		mappedSize = 0;
+	}
+
+private:
+	struct FileHeader {
+		char magic[8];
+		int32_t start;
+		int32_t limit;
+	};
+
+	const int32_t* parents = nullptr; // родитель числа, -1 - недостижимо, у a - само a
+	int startValue = -1;
+	int maxValue = -1;
+
+	vector<int32_t> ownedParents;
+	void* mappedView = nullptr;
+	size_t mappedSize = 0;
+#ifdef _WIN32
+	HANDLE fileHandle = INVALID_HANDLE_VALUE;
+	HANDLE mappingHandle = nullptr;
+#endif
+
+	static FileHeader makeHeader(int a, int limit) {
+		FileHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, "IS1TREE", 8);
+		header.start = a;
+		header.limit = limit;
+		return header;
+	}
+};
+
+// Наибольшее число в запросах: дерево до него занимает 4 байта на число (800 МБ)
+const int MAX_QUERY_VALUE = 200000000;
+
+struct Query {
+	int a, b;
+	vector<int> path;
+	bool skipped = false; // дерево не удалось построить
+};
+
+// Дерево для a, покрывающее b <= limit: из файла cachePrefix<a>.bin или построением с сохранением
+static void prepareTree(BfsTreeCache& tree, int a, int limit, const string& cachePrefix) {
+	if (tree.covers(a, limit)) return;
+	string cacheFile = cachePrefix.empty() ? "" : cachePrefix + to_string(a) + ".bin";
+	if (!cacheFile.empty() && tree.load(cacheFile) && tree.covers(a, limit)) return;
+	tree.build(a, limit);
+	if (!cacheFile.empty() && tree.save(cacheFile)) tree.load(cacheFile);
+}
+
+// Читает пары «a b» (по одной в строке, '#' - комментарий) и отвечает на них по общему дереву.
+// Запросы группируются по a, дерево строится один раз до наибольшего b группы
+static int runQueries(const string& inputFile, const string& outputFile, const string& cachePrefix) {
+	vector<Query> queries;
+	ifstream file;
+	istream* in = &cin;
+	if (inputFile != "-") {
+		file.open(inputFile);
+		if (!file.is_open()) {
+			cerr << "Cannot open file " << inputFile << endl;
+			return 1;
+		}
+		in = &file;
+	}
+	string line;
+	while (getline(*in, line)) {
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == string::npos || line[first] == '#') continue;
+		istringstream fields(line);
+		Query q;
+		if (!(fields >> q.a >> q.b) || q.a < 0 || q.b < 0 || q.a > MAX_QUERY_VALUE || q.b > MAX_QUERY_VALUE) {
+			cerr << "Skipping invalid query: " << line << endl;
+			continue;
+		}
+		queries.push_back(q);
+	}
+
+	vector<size_t> order(queries.size());
+	for (size_t i = 0; i < order.size(); i++) order[i] = i;
+	stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) { return queries[x].a < queries[y].a; });
+
+	BfsTreeCache tree;
+	double treeMs = 0;
+	auto batchStart = steady_clock::now();
+	for (size_t i = 0; i < order.size();) {
+		int a = queries[order[i]].a;
+		int limit = a;
+		size_t groupEnd = i;
+		for (; groupEnd < order.size() && queries[order[groupEnd]].a == a; groupEnd++) {
+			limit = max(limit, queries[order[groupEnd]].b);
+		}
+		auto treeStart = steady_clock::now();
+		try {
+			prepareTree(tree, a, limit, cachePrefix);
+		}
+		catch (const bad_alloc&) {
+			tree.unload();
+			cerr << "Not enough memory for the tree of a=" << a << " up to " << limit
+				<< ", skipping " << groupEnd - i << " queries" << endl;
+			for (; i < groupEnd; i++) queries[order[i]].skipped = true;
+			continue;
+		}
+		treeMs += duration_cast<microseconds>(steady_clock::now() - treeStart).count() / 1000.0;
+		for (; i < groupEnd; i++) {
+			Query& q = queries[order[i]];
+			q.path = tree.pathTo(q.b);
+		}
+	}
+	double totalMs = duration_cast<microseconds>(steady_clock::now() - batchStart).count() / 1000.0;
+
+	ofstream outFile;
+	ostream* out = &cout;
+	if (outputFile != "-") {
+		outFile.open(outputFile);
+		if (!outFile.is_open()) {
+			cerr << "Cannot open file " << outputFile << endl;
+			return 1;
+		}
+		out = &outFile;
+	}
+	*out << "a,b,operations,path" << endl;
+	for (const Query& q : queries) {
+		if (q.skipped) continue;
+		*out << q.a << "," << q.b << "," << (int)q.path.size() - 1 << ",";
+		for (size_t i = 0; i < q.path.size(); i++) *out << (i ? " " : "") << q.path[i];
+		*out << endl;
+	}
+
+	size_t n = max<size_t>(queries.size(), 1);
+	cerr << "Queries: " << queries.size() << ", trees " << treeMs << " ms, total " << totalMs << " ms" << endl;
+	cerr << "Per query: " << (totalMs - treeMs) * 1000 / n << " us without trees, "
+		<< totalMs * 1000 / n << " us amortized" << endl;
+	return 0;
+}
+
+// Замеры: все задачи на парах чисел возрастающего масштаба
+// IS_1 --bench [--warmup N] [--reps N] [--filter S] [--save file] [--baseline file] [--tolerance X]
+int runBenchmarks(const BenchmarkOptions& options) {
+	const pair<int, int> pairs[] = { {2, 100}, {2, 100000}, {7, 1000003}, {2, 10000001} };
+	struct Engine {
+		const char* name;
+		vector<int>(*func)(int, int);
+		bool subtract2; // набор операций задачи 2
+	};
+	const Engine engines[] = {
+		{"task1", task1, false}, {"task2", task2, true}, {"task3", task3, false}, {"task4", task4, false},
+		{"ops1-forward", forwardSearch<Task1Ops>, false}, {"ops1-backward", backwardSearch<Task1Ops>, false},
+		{"ops1-bidirectional", bidirectionalSearch<Task1Ops>, false}, {"ops2-forward", forwardSearch<Task2Ops>, true},
+		{"ops2-bidirectional", bidirectionalSearch<Task2Ops>, true}, {"ops1-parallel", parallelSearchAll<Task1Ops>, false},
+		{"ops2-parallel", parallelSearchAll<Task2Ops>, true}
+	};
+
+	// Узлы случая - раскрытые числа. Длина пути - отдельная проверка поведения: каждый движок
+	// должен найти путь той же длины, что task1 (task2 для набора с вычитанием)
+	BenchmarkSuite suite(options);
+	auto wrongPaths = make_shared<vector<string>>();
+	for (auto& p : pairs) {
+		int a = p.first, b = p.second;
+		const int expected[2] = { pathLength(task1(a, b), a, b), pathLength(task2(a, b), a, b) };
+		for (const Engine& engine : engines) {
+			string name = string(engine.name) + "/" + to_string(a) + "-" + to_string(b);
+			auto func = engine.func;
+			int length = expected[engine.subtract2];
+			suite.add(name, [func, a, b, length, name, wrongPaths]() {
+				int found = pathLength(func(a, b), a, b);
+				string error = name + ": path length " + to_string(found) + ", expected " + to_string(length);
+				if (found != length && find(wrongPaths->begin(), wrongPaths->end(), error) == wrongPaths->end()) {
+					wrongPaths->push_back(error);
+				}
+				return lastSearch.expanded;
+				});
+		}
+	}
+	for (auto& p : pairs) {
+		for (bool subtract2 : { false, true }) {
+			long long a = p.first, b = p.second;
+			suite.add(string(subtract2 ? "lean-sub" : "lean") + "/" + to_string(a) + "-" + to_string(b), [a, b, subtract2]() {
+				LeanSearchInfo info;
+				leanSearch(a, b, subtract2, info);
+				return info.stats.expanded;
+				});
+		}
+	}
+	int code = suite.run(cout);
+	for (const string& error : *wrongPaths) cout << "WRONG PATH " << error << endl;
+	if (!wrongPaths->empty()) code = 1;
+
+	// ускорение двунаправленного поиска относительно прямого и обратного
+	for (auto& p : pairs) {
+		string suffix = "/" + to_string(p.first) + "-" + to_string(p.second);
+		const BenchmarkResult* bidirectional = suite.find("task4" + suffix);
+		if (bidirectional == nullptr || bidirectional->medianMs <= 0) continue;
+		ostringstream speedup;
+		speedup << fixed << setprecision(2);
+		for (const char* other : { "task1", "task3" }) {
+			const BenchmarkResult* r = suite.find(other + suffix);
+			if (r != nullptr) speedup << " x" << r->medianMs / bidirectional->medianMs << " vs " << other;
+		}
+		if (!speedup.str().empty()) cout << "task4" << suffix << " speedup:" << speedup.str() << endl;
+	}
+	return code;
+}
+
+int main(int argc, char* argv[])
 {
+	BenchmarkOptions benchOptions;
+	if (parseBenchmarkArgs(argc, argv, benchOptions)) {
+		return runBenchmarks(benchOptions);
+	}
+
+	// IS_1 --queries <file|-> [--out file] [--cache prefix]
+	for (int i = 1; i < argc; i++) {
+		if (string(argv[i]) != "--queries") continue;
+		// файл - следующий аргумент, если это не ключ; иначе стандартный ввод
+		string inputFile = "-";
+		if (i + 1 < argc && (string(argv[i + 1]) == "-" || string(argv[i + 1]).compare(0, 2, "--") != 0)) {
+			inputFile = argv[i + 1];
+		}
+		string outputFile = "-";
+		string cachePrefix;
+		for (int j = 1; j < argc; j++) {
+			string arg = argv[j];
+			if (arg == "--out" && j + 1 < argc) outputFile = argv[++j];
+			else if (arg == "--cache" && j + 1 < argc) cachePrefix = argv[++j];
+		}
+		return runQueries(inputFile, outputFile, cachePrefix);
+	}
+
 	int a = 2;
 	int b = 10000001;
 	cout << "---Task1---" << endl;
@@ -215,4 +1071,19 @@ int main()
 	print(a, b, task3);
 	cout << "---Task4---" << endl;
 	print(a, b, task4);
+	cout << "---Generic engine (+3, *2)---" << endl;
+	print(a, b, forwardSearch<Task1Ops>);
+	print(a, b, backwardSearch<Task1Ops>);
+	print(a, b, bidirectionalSearch<Task1Ops>);
+	cout << "---Generic engine (+3, *2, -2)---" << endl;
+	print(a, b, forwardSearch<Task2Ops>);
+	print(a, b, bidirectionalSearch<Task2Ops>);
+	cout << "---Parallel engine (" << thread::hardware_concurrency() << " threads)---" << endl;
+	print(a, b, parallelSearchAll<Task1Ops>);
+	print(a, b, parallelSearchAll<Task2Ops>);
+	cout << "---Lean engine---" << endl;
+	printLean(a, b, false);
+	printLean(a, b, true);
+	printLean(a, 1000000000, false);
+	printLean(a, 1000000000, true);
 }
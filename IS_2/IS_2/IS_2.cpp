@@ -3,41 +3,433 @@
 #include <vector>
 #include <queue>
 #include <stack>
-#include <unordered_map>
 #include <algorithm>
 #include <fstream>
 #include <chrono>
+#include <cstdint>
+#include <climits>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../../Common/FlatStateTable.h"
+#include "../../Common/SearchStats.h"
+#include "../../Common/Benchmark.h"
 
 using namespace std;
 using namespace std::chrono;
 
+// ========== Аддитивная база шаблонов (6-6-3) ==========
+// Плитки разбиты на три непересекающиеся группы. Для каждой группы обратным поиском в ширину
+// от цели считается минимальное число ходов плиток группы (ходы остальных плиток бесплатны),
+// поэтому значения групп можно складывать. Таблица индексируется рангом размещения клеток
+// плиток группы: 16*15*14*13*12*11 байт для шести плиток.
+class PatternDatabase {
+public:
+    static const int GROUP_COUNT = 3;
+    static const int MAX_GROUP_TILES = 6;
+
+    PatternDatabase() {
+        size_t offset = 0;
+        for (int g = 0; g < GROUP_COUNT; g++) {
+            tableOffsets[g] = offset;
+            offset += tableSize(GROUP_SIZES[g]);
+            tables[g] = nullptr;
+        }
+        totalSize = offset;
+        for (int tile = 0; tile < 16; tile++) tileGroup[tile] = -1;
+        for (int g = 0; g < GROUP_COUNT; g++) {
+            for (int i = 0; i < GROUP_SIZES[g]; i++) tileGroup[GROUP_TILES[g][i]] = g;
+        }
+    }
+
+    ~PatternDatabase() { unload(); }
+
+    PatternDatabase(const PatternDatabase&) = delete;
+    PatternDatabase& operator=(const PatternDatabase&) = delete;
+
+    bool isLoaded() const { return tables[0] != nullptr; }
+
+    int groupOf(int tile) const { return tileGroup[tile]; }
+
+    // tile_pos[плитка] = клетка
+    int groupValue(int group, const uint8_t tile_pos[16]) const {
+        uint8_t cells[MAX_GROUP_TILES];
+        for (int i = 0; i < GROUP_SIZES[group]; i++) cells[i] = tile_pos[GROUP_TILES[group][i]];
+        return tables[group][rankCells(cells, GROUP_SIZES[group])];
+    }
+
+    int lookup(const uint8_t tile_pos[16]) const {
+        int h = 0;
+        for (int g = 0; g < GROUP_COUNT; g++) h += groupValue(g, tile_pos);
+        return h;
+    }
+
+    // Построение всех таблиц в памяти
+    void build() {
+        unload();
+        ownedData.assign(totalSize, (uint8_t)UNSEEN);
+        for (int g = 0; g < GROUP_COUNT; g++) {
+            tables[g] = ownedData.data() + tableOffsets[g];
+            buildGroup(g, ownedData.data() + tableOffsets[g]);
+        }
+    }
+
+    bool save(const string& filename) const {
+        if (!isLoaded()) return false;
+        ofstream file(filename, ios::binary);
+        if (!file.is_open()) {
+            cout << "Cannot open file " << filename << endl;
+            return false;
+        }
+        FileHeader header = makeHeader();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (int g = 0; g < GROUP_COUNT; g++) {
+            file.write(reinterpret_cast<const char*>(tables[g]), tableSize(GROUP_SIZES[g]));
+        }
+        return (bool)file;
+    }
+
+    // Отображение файла в память без копирования
+    bool load(const string& filename) {
+        unload();
+#ifdef _WIN32
+        fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize) || (size_t)fileSize.QuadPart != sizeof(FileHeader) + totalSize) {
+            unload();
+            return false;
+        }
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr) {
+            unload();
+            return false;
+        }
+        mappedView = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (mappedView == nullptr) {
+            unload();
+            return false;
+        }
+        mappedSize = (size_t)fileSize.QuadPart;
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size != sizeof(FileHeader) + totalSize) {
+            close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED) return false;
+        mappedView = view;
+        mappedSize = (size_t)info.st_size;
+#endif
+        FileHeader expected = makeHeader();
+        if (memcmp(mappedView, &expected, sizeof(expected)) != 0) {
+            cout << "Pattern database " << filename << " has a different layout" << endl;
+            unload();
+            return false;
+        }
+        const uint8_t* data = static_cast<const uint8_t*>(mappedView) + sizeof(FileHeader);
+        for (int g = 0; g < GROUP_COUNT; g++) tables[g] = data + tableOffsets[g];
+        return true;
+    }
+
+    void unload() {
+        for (int g = 0; g < GROUP_COUNT; g++) tables[g] = nullptr;
+        vector<uint8_t>().swap(ownedData);
+#ifdef _WIN32
+        if (mappedView != nullptr) UnmapViewOfFile(mappedView);
+        if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (mappedView != nullptr) munmap(mappedView, mappedSize);
+#endif
+        mappedView = nullptr;
+        mappedSize = 0;
+    }
+
+private:
+    static const uint8_t UNSEEN = 0xFF;
+    static const int GROUP_SIZES[GROUP_COUNT];
+    static const int GROUP_TILES[GROUP_COUNT][MAX_GROUP_TILES];
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t groupCount;
+        uint8_t groupTiles[GROUP_COUNT][8];
+    };
+
+    const uint8_t* tables[GROUP_COUNT];
+    size_t tableOffsets[GROUP_COUNT];
+    size_t totalSize;
+    int tileGroup[16];
+
+    vector<uint8_t> ownedData;
+    void* mappedView = nullptr;
+    size_t mappedSize = 0;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#endif
+
+    static size_t tableSize(int tiles) {
+        size_t size = 1;
+        for (int i = 0; i < tiles; i++) size *= (size_t)(16 - i);
+        return size;
+    }
+
+    static int bitCount(uint32_t x) {
+        x = x - ((x >> 1) & 0x55555555u);
+        x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+        return (int)((((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+    }
+
+    // Ранг упорядоченного размещения k различных клеток из 16
+    static uint32_t rankCells(const uint8_t* cells, int k) {
+        uint32_t rank = 0;
+        uint32_t used = 0;
+        for (int i = 0; i < k; i++) {
+            int cell = cells[i];
+            rank = rank * (uint32_t)(16 - i) + (uint32_t)(cell - bitCount(used & ((1u << cell) - 1)));
+            used |= 1u << cell;
+        }
+        return rank;
+    }
+
+    // Соседние клетки маски на доске 4x4
+    static uint32_t neighborMask(uint32_t mask) {
+        return ((mask >> 1) & 0x7777u) | ((mask << 1) & 0xEEEEu) | (mask >> 4) | ((mask << 4) & 0xFFFFu);
+    }
+
+    FileHeader makeHeader() const {
+        FileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "IS2PDB1", 8);
+        header.version = 1;
+        header.groupCount = GROUP_COUNT;
+        for (int g = 0; g < GROUP_COUNT; g++) {
+            for (int i = 0; i < GROUP_SIZES[g]; i++) header.groupTiles[g][i] = (uint8_t)GROUP_TILES[g][i];
+        }
+        return header;
+    }
+
+    // Обратный BFS по слоям стоимости. Состояние - клетки плиток группы (по 4 бита)
+    // и клетка пустой в битах 24..27. Пустая свободно ходит по своей области,
+    // поэтому за раз раскрывается вся связная область пустых клеток.
+    void buildGroup(int group, uint8_t* table) {
+        const int k = GROUP_SIZES[group];
+        const size_t size = tableSize(k);
+        vector<uint64_t> seen((size * 16 + 63) / 64, 0);
+        vector<uint64_t> expanded((size * 16 + 63) / 64, 0);
+        auto testBit = [](const vector<uint64_t>& bits, size_t i) { return (bits[i >> 6] >> (i & 63)) & 1; };
+        auto setBit = [](vector<uint64_t>& bits, size_t i) { bits[i >> 6] |= 1ULL << (i & 63); };
+
+        uint8_t cells[MAX_GROUP_TILES];
+        uint32_t start = 15u << 24;
+        for (int i = 0; i < k; i++) {
+            cells[i] = (uint8_t)(GROUP_TILES[group][i] - 1);
+            start |= (uint32_t)cells[i] << (4 * i);
+        }
+        uint32_t startRank = rankCells(cells, k);
+        table[startRank] = 0;
+        setBit(seen, (size_t)startRank * 16 + 15);
+
+        vector<uint32_t> layer(1, start), next;
+        for (int cost = 0; !layer.empty(); cost++) {
+            next.clear();
+            for (uint32_t state : layer) {
+                uint32_t occupied = 0;
+                for (int i = 0; i < k; i++) {
+                    cells[i] = (uint8_t)((state >> (4 * i)) & 0xF);
+                    occupied |= 1u << cells[i];
+                }
+                uint32_t rank = rankCells(cells, k);
+                int blank = (int)(state >> 24);
+                if (testBit(expanded, (size_t)rank * 16 + blank)) continue;
+
+                uint32_t region = 1u << blank;
+                for (uint32_t grown = region; ; region = grown) {
+                    grown = (region | neighborMask(region)) & ~occupied & 0xFFFFu;
+                    if (grown == region) break;
+                }
+                for (int cell = 0; cell < 16; cell++) {
+                    if (region & (1u << cell)) {
+                        setBit(expanded, (size_t)rank * 16 + cell);
+                        setBit(seen, (size_t)rank * 16 + cell);
+                    }
+                }
+
+                for (int i = 0; i < k; i++) {
+                    int from = cells[i];
+                    uint32_t targets = neighborMask(1u << from) & region;
+                    for (int to = 0; to < 16; to++) {
+                        if (!(targets & (1u << to))) continue;
+                        cells[i] = (uint8_t)to;
+                        uint32_t newRank = rankCells(cells, k);
+                        cells[i] = (uint8_t)from;
+                        size_t key = (size_t)newRank * 16 + from;
+                        if (testBit(seen, key)) continue;
+                        setBit(seen, key);
+                        if (table[newRank] == UNSEEN) table[newRank] = (uint8_t)(cost + 1);
+                        uint32_t newState = (state & ~(0xFu << (4 * i)) & 0x00FFFFFFu)
+                            | ((uint32_t)to << (4 * i)) | ((uint32_t)from << 24);
+                        next.push_back(newState);
+                    }
+                }
+            }
+            layer.swap(next);
+        }
+    }
+};
+
+// Разбиение Корфа-Фелнера 6-6-3
+const int PatternDatabase::GROUP_SIZES[PatternDatabase::GROUP_COUNT] = { 6, 6, 3 };
+const int PatternDatabase::GROUP_TILES[PatternDatabase::GROUP_COUNT][PatternDatabase::MAX_GROUP_TILES] = {
+    { 1, 5, 6, 9, 10, 13 },
+    { 7, 8, 11, 12, 14, 15 },
+    { 2, 3, 4 }
+};
+
 class Puzzle15Solver {
+public:
+    // Default - собственная эвристика алгоритма, PatternDatabase - аддитивная база шаблонов,
+    // WalkingDistance - таблица walking distance по строкам и столбцам
+    enum class Heuristic { Default, PatternDatabase, WalkingDistance };
+
 private:
+    Heuristic heuristic = Heuristic::Default;
+    const PatternDatabase* patternDb = nullptr;
+    bool verbose = true;              // печатать ли сообщения решателей
+    SearchStats stats;                // статистика последнего поиска
+
     const int SIZE = 4;
     const int TOTAL_CELLS = 16;
     const string GOAL = "123456789ABCDEF0";
+    // Доска упакована в uint64_t: по 4 бита на клетку, клетка 0 в старшей тетраде,
+    // поэтому hex-запись числа совпадает со строкой состояния
+    const uint64_t GOAL_PACKED = 0x123456789ABCDEF0ULL;
 
-    const vector<pair<int, int>> DIRECTIONS = { {-1, 0}, {0, 1}, {1, 0}, {0, -1} };//y:x
     const vector<char> DIR_NAMES = { 'U', 'R', 'D', 'L' };
 
-    struct Node {
-        string state;
-        string path;
-        int empty_pos;
-        int g;
-        int h;
+    static const uint32_t NO_PARENT = UINT32_MAX;
 
-        Node(string s, string p, int e)
-            : state(s), path(p), empty_pos(e) {
-        }
-        Node(string s, string p, int e, int g_val, int h_val)
-            : state(s), path(p), empty_pos(e), g(g_val), h(h_val) {
+    // Узел поиска фиксированного размера: вместо строки пути храним индекс предка
+    // в списке узлов и номер хода, путь восстанавливается один раз в конце
+    struct Node {
+        uint64_t state;
+        uint32_t parent;
+        uint8_t empty_pos;
+        uint8_t move; // индекс в DIR_NAMES
+        uint8_t g;
+        uint8_t h;
+
+        Node() : Node(0, 0) {}
+        Node(uint64_t s, int e, uint32_t p = NO_PARENT, int m = 0, int g_val = 0, int h_val = 0)
+            : state(s), parent(p), empty_pos((uint8_t)e), move((uint8_t)m), g((uint8_t)g_val), h((uint8_t)h_val) {
         }
 
         int f() const { return g + h; }
+    };
+
+    // Элемент открытого списка A*: f и индекс узла
+    struct OpenEntry {
+        int f;
+        uint32_t index;
+
+        bool operator>(const OpenEntry& other) const {
+            return f > other.f;
+        }
+    };
+
+    // Открытый список на двоичной куче (прежняя реализация, оставлена для сравнения)
+    class HeapOpenList {
+        struct Heap : priority_queue<OpenEntry, vector<OpenEntry>, greater<OpenEntry>> {
+            size_t capacity() const { return c.capacity(); }
+        };
+        Heap heap;
+        size_t peak = 0;
+
+    public:
+        void push(int f, int, uint32_t index) {
+            heap.push({ f, index });
+            peak = max(peak, heap.size());
+        }
+        bool empty() const { return heap.empty(); }
+        uint32_t pop() {
+            uint32_t index = heap.top().index;
+            heap.pop();
+            return index;
+        }
+        size_t peakSize() const { return peak; }
+        size_t memoryBytes() const { return heap.capacity() * sizeof(OpenEntry); }
+    };
 
-        bool operator>(const Node& other) const {
-            return f() > other.f();
+    // Открытый список из корзин по целому f, внутри f - корзины по g. Берётся наименьший f,
+    // среди равных - наибольший g (узел ближе к цели). push и pop за O(1).
+    class BucketOpenList {
+        vector<vector<vector<uint32_t>>> buckets; // [f][g] -> индексы узлов
+        vector<int> top_g;                        // [f] -> наибольший g, где могут быть узлы
+        int min_f = INT_MAX;
+        size_t count = 0;
+        size_t peak = 0;
+
+    public:
+        void push(int f, int g, uint32_t index) {
+            if (f >= (int)buckets.size()) {
+                buckets.resize(f + 1);
+                top_g.resize(f + 1, -1);
+            }
+            if (g >= (int)buckets[f].size()) buckets[f].resize(g + 1);
+            buckets[f][g].push_back(index);
+            top_g[f] = max(top_g[f], g);
+            min_f = min(min_f, f); // эвристика может быть несогласованной, f потомка бывает меньше
+            peak = max(peak, ++count);
+        }
+        bool empty() const { return count == 0; }
+        uint32_t pop() {
+            while (top_g[min_f] < 0) min_f++;
+            vector<vector<uint32_t>>& by_g = buckets[min_f];
+            while (by_g[top_g[min_f]].empty()) top_g[min_f]--;
+            uint32_t index = by_g[top_g[min_f]].back();
+            by_g[top_g[min_f]].pop_back();
+            while (top_g[min_f] >= 0 && by_g[top_g[min_f]].empty()) top_g[min_f]--;
+            count--;
+            return index;
+        }
+        size_t peakSize() const { return peak; }
+        size_t memoryBytes() const {
+            size_t bytes = buckets.capacity() * sizeof(buckets[0]) + top_g.capacity() * sizeof(int);
+            for (const auto& by_g : buckets) {
+                bytes += by_g.capacity() * sizeof(by_g[0]);
+                for (const auto& bucket : by_g) bytes += bucket.capacity() * sizeof(uint32_t);
+            }
+            return bytes;
         }
     };
 
@@ -47,26 +439,66 @@ private:
         return -1;
     }
 
-    vector<Node> getNeighbors(const Node& node) {
-        vector<Node> neighbors;
-        int empty_row = node.empty_pos / SIZE;
-        int empty_col = node.empty_pos % SIZE;
+    static int tileShift(int pos) { return (15 - pos) * 4; }
 
-        for (int i = 0; i < 4; i++) {
-            int new_row = empty_row + DIRECTIONS[i].first;
-            int new_col = empty_col + DIRECTIONS[i].second;
+    static int getTile(uint64_t state, int pos) {
+        return (int)((state >> tileShift(pos)) & 0xF);
+    }
 
-            if (new_row >= 0 && new_row < SIZE && new_col >= 0 && new_col < SIZE) {
-                int new_pos = new_row * SIZE + new_col;
-                string new_state = node.state;
+    // Перенос плитки из new_pos в пустую клетку empty_pos (тетрада пустой клетки равна 0)
+    static uint64_t moveTile(uint64_t state, int empty_pos, int new_pos) {
+        uint64_t tile = (state >> tileShift(new_pos)) & 0xF;
+        return (state & ~(0xFULL << tileShift(new_pos))) | (tile << tileShift(empty_pos));
+    }
 
-                swap(new_state[node.empty_pos], new_state[new_pos]);
+    uint64_t packState(const string& state) {
+        uint64_t packed = 0;
+        for (int i = 0; i < TOTAL_CELLS; i++) {
+            packed = (packed << 4) | (uint64_t)hexCharToInt(state[i]);
+        }
+        return packed;
+    }
 
-                neighbors.push_back(Node(new_state, node.path + DIR_NAMES[i], new_pos));
-            }
+    // Потомки узла в массиве фиксированного размера, без выделения памяти
+    struct Neighbors {
+        Node items[4];
+        int count = 0;
+
+        const Node* begin() const { return items; }
+        const Node* end() const { return items + count; }
+    };
+
+    // Потомки узла по таблице ходов пустой клетки: parent заполняет вызывающий, g увеличен на 1.
+    // Ход, отменяющий ход родителя, пропускается - он ведёт в уже посещённое состояние.
+    void getNeighbors(const Node& node, Neighbors& neighbors) {
+        const IncrementalTables& t = incrementalTables();
+        neighbors.count = 0;
+
+        for (int dir = 0; dir < 4; dir++) {
+            if (node.parent != NO_PARENT && dir == (node.move + 2) % 4) continue;
+            int new_pos = t.blankMoves[node.empty_pos][dir];
+            if (new_pos < 0) continue;
+
+            uint64_t new_state = moveTile(node.state, node.empty_pos, new_pos);
+            neighbors.items[neighbors.count++] = Node(new_state, new_pos, NO_PARENT, dir, node.g + 1);
         }
+    }
 
-        return neighbors;
+    // Порождение потомков с учётом в статистике
+    void expandNode(const Node& node, Neighbors& neighbors) {
+        PhaseTimer timer(stats.timePhases, stats.moveGenMs);
+        getNeighbors(node, neighbors);
+        stats.generated += neighbors.count;
+    }
+
+    string buildPath(const vector<Node>& nodes, uint32_t index) {
+        string path;
+        while (nodes[index].parent != NO_PARENT) {
+            path += DIR_NAMES[nodes[index].move];
+            index = nodes[index].parent;
+        }
+        reverse(path.begin(), path.end());
+        return path;
     }
 
     //  pos[i] = i.y, i.x
@@ -80,15 +512,14 @@ private:
         return goal_pos;
     }
 
-    int manhattanDistance(const string& state) {
+    int manhattanDistance(uint64_t state) {
         static const vector<pair<int, int>> goal_pos = getGoalPositions();
         int distance = 0;
 
         for (int i = 0; i < TOTAL_CELLS; i++) {
-            char c = state[i];
-            if (c == '0') continue;
+            int val = getTile(state, i);
+            if (val == 0) continue;
 
-            int val = hexCharToInt(c);
             int current_row = i / SIZE;
             int current_col = i % SIZE;
             int goal_row = goal_pos[val].first;
@@ -99,22 +530,20 @@ private:
         return distance;
     }
 
-    int linearConflicts(const string& state) {
+    int linearConflicts(uint64_t state) {
         int conflicts = 0;
 
         //  в строках
         for (int row = 0; row < SIZE; row++) {
             for (int i = 0; i < SIZE; i++) {
-                char tile1 = state[row * SIZE + i];
-                if (tile1 == '0') continue;
-                int val1 = hexCharToInt(tile1);
+                int val1 = getTile(state, row * SIZE + i);
+                if (val1 == 0) continue;
                 int goal_row1 = (val1 - 1) / SIZE;
                 if (goal_row1 != row) continue;
 
                 for (int j = i + 1; j < SIZE; j++) {
-                    char tile2 = state[row * SIZE + j];
-                    if (tile2 == '0') continue;
-                    int val2 = hexCharToInt(tile2);
+                    int val2 = getTile(state, row * SIZE + j);
+                    if (val2 == 0) continue;
                     int goal_row2 = (val2 - 1) / SIZE;
                     if (goal_row2 != row) continue;
 
@@ -128,16 +557,14 @@ private:
         // в столбцах
         for (int col = 0; col < SIZE; col++) {
             for (int i = 0; i < SIZE; i++) {
-                char tile1 = state[i * SIZE + col];
-                if (tile1 == '0') continue;
-                int val1 = hexCharToInt(tile1);
+                int val1 = getTile(state, i * SIZE + col);
+                if (val1 == 0) continue;
                 int goal_col1 = (val1 - 1) % SIZE;
                 if (goal_col1 != col) continue;
 
                 for (int j = i + 1; j < SIZE; j++) {
-                    char tile2 = state[j * SIZE + col];
-                    if (tile2 == '0') continue;
-                    int val2 = hexCharToInt(tile2);
+                    int val2 = getTile(state, j * SIZE + col);
+                    if (val2 == 0) continue;
                     int goal_col2 = (val2 - 1) % SIZE;
                     if (goal_col2 != col) continue;
 
@@ -151,38 +578,38 @@ private:
         return conflicts;
     }
 
-    int cornerConflicts(const string& state) {
+    int cornerConflicts(uint64_t state) {
         int conflicts = 0;
 
         // Левый верхний угол (0,0)
-        char top_left = state[0];
-        if (top_left != '1' && top_left != '0') {
-            char right = state[1]; 
-            char down = state[4];  
+        int top_left = getTile(state, 0);
+        if (top_left != 1 && top_left != 0) {
+            int right = getTile(state, 1);
+            int down = getTile(state, 4);
 
-            if (right == '2' && down == '5') {
+            if (right == 2 && down == 5) {
                 conflicts += 2;
             }
         }
 
         // Правый верхний угол (0,3)  
-        char top_right = state[3];
-        if (top_right != '4' && top_right != '0') {
-            char left = state[2];  
-            char down = state[7];  
+        int top_right = getTile(state, 3);
+        if (top_right != 4 && top_right != 0) {
+            int left = getTile(state, 2);
+            int down = getTile(state, 7);
 
-            if (left == '3' && down == '8') {
+            if (left == 3 && down == 8) {
                 conflicts += 2;
             }
         }
 
         // Левый нижний угол (3,0)
-        char bottom_left = state[12];
-        if (bottom_left != 'D' && bottom_left != '0') { 
-            char right = state[13];  
-            char up = state[8];     
+        int bottom_left = getTile(state, 12);
+        if (bottom_left != 13 && bottom_left != 0) {
+            int right = getTile(state, 13);
+            int up = getTile(state, 8);
 
-            if (right == 'E' && up == '9') { 
+            if (right == 14 && up == 9) {
                 conflicts += 2;
             }
         }
@@ -190,15 +617,385 @@ private:
         return conflicts;
     }
 
-    int combinedHeuristic(const string& state) {
+    int combinedHeuristic(uint64_t state) {
         int manhattan = manhattanDistance(state);
         int linear = linearConflicts(state);
         int corner = cornerConflicts(state);
         return manhattan + linear + corner;
     }
 
+    void fillTilePositions(uint64_t state, uint8_t tile_pos[16]) {
+        for (int pos = 0; pos < TOTAL_CELLS; pos++) {
+            tile_pos[getTile(state, pos)] = (uint8_t)pos;
+        }
+    }
+
+    bool usePatternDb() const {
+        return heuristic == Heuristic::PatternDatabase && patternDb != nullptr && patternDb->isLoaded();
+    }
+
+    // ========== Walking distance ==========
+    // Состояние строк: сколько плиток с целевой строкой g стоит в строке r (матрица 4x4)
+    // и строка пустой клетки. Вертикальный ход переносит одну плитку между соседними строками,
+    // горизонтальный состояние строк не меняет. Расстояния до цели считаются обратным BFS
+    // (24964 состояния, доли секунды), столбцы используют ту же таблицу для транспонированной
+    // доски. Сумма расстояний строк и столбцов допустима и не меньше манхэттенского.
+
+    struct WalkingDistanceTable {
+        vector<uint8_t> distance; // [состояние]
+        vector<int32_t> next;     // [состояние * 8 + направление * 4 + целевая линия плитки], -1 если нельзя
+        FlatStateTable<uint64_t, int32_t> index; // упакованная матрица -> номер состояния
+
+        WalkingDistanceTable() : index(1 << 15) {}
+    };
+
+    // Матрица упакована по 3 бита на счётчик ((линия * 4 + целевая линия) * 3), линия пустой в битах 48-49
+    static int walkingShift(int line, int goal_line) { return (line * 4 + goal_line) * 3; }
+
+    static const WalkingDistanceTable& walkingDistanceTable() {
+        static const WalkingDistanceTable* table = [] {
+            WalkingDistanceTable* t = new WalkingDistanceTable();
+            // цель: в каждой линии свои плитки, в последней три плитки и пустая
+            uint64_t goal = 3ULL << 48;
+            for (int line = 0; line < 4; line++) goal += (uint64_t)(line == 3 ? 3 : 4) << walkingShift(line, line);
+
+            vector<uint64_t> keys(1, goal);
+            t->index[goal] = 0;
+            t->distance.push_back(0);
+            for (size_t head = 0; head < keys.size(); head++) {
+                uint64_t key = keys[head];
+                int blank = (int)(key >> 48);
+                for (int dir = 0; dir < 2; dir++) {
+                    int from = dir == 0 ? blank - 1 : blank + 1; // линия, откуда плитка переходит к пустой
+                    for (int goal_line = 0; goal_line < 4; goal_line++) {
+                        int32_t child = -1;
+                        if (from >= 0 && from < 4 && ((key >> walkingShift(from, goal_line)) & 7) != 0) {
+                            uint64_t next_key = key - (1ULL << walkingShift(from, goal_line)) + (1ULL << walkingShift(blank, goal_line));
+                            next_key = (next_key & ~(3ULL << 48)) | ((uint64_t)from << 48);
+                            auto inserted = t->index.insert(next_key, (int32_t)keys.size());
+                            if (inserted.second) {
+                                keys.push_back(next_key);
+                                t->distance.push_back((uint8_t)(t->distance[head] + 1));
+                            }
+                            child = *inserted.first;
+                        }
+                        t->next.push_back(child);
+                    }
+                }
+            }
+            return t;
+        }();
+        return *table;
+    }
+
+    // Номер состояния строк (columns = false) или столбцов (columns = true) доски
+    static int walkingIndex(uint64_t state, bool columns) {
+        uint64_t key = 0;
+        for (int pos = 0; pos < 16; pos++) {
+            int tile = getTile(state, pos);
+            int line = columns ? pos % 4 : pos / 4;
+            if (tile == 0) {
+                key |= (uint64_t)line << 48;
+            }
+            else {
+                key += 1ULL << walkingShift(line, columns ? (tile - 1) % 4 : (tile - 1) / 4);
+            }
+        }
+        return *walkingDistanceTable().index.find(key);
+    }
+
+    int walkingDistance(uint64_t state) {
+        const WalkingDistanceTable& t = walkingDistanceTable();
+        return t.distance[walkingIndex(state, false)] + t.distance[walkingIndex(state, true)];
+    }
+
+    int aStarHeuristic(uint64_t state) {
+        PhaseTimer timer(stats.timePhases, stats.heuristicMs);
+        stats.heuristicEvaluations++;
+        if (usePatternDb()) {
+            uint8_t tile_pos[16];
+            fillTilePositions(state, tile_pos);
+            return patternDb->lookup(tile_pos);
+        }
+        if (heuristic == Heuristic::WalkingDistance) return walkingDistance(state);
+        return combinedHeuristic(state);
+    }
+
+    // ========== IDA* с инкрементальной эвристикой ==========
+    // Манхэттен + линейные конфликты. Конфликты в линии считаются как 2 * (плиток своей
+    // линии - длина наибольшей возрастающей подпоследовательности), это допустимая оценка.
+    // После хода пересчитываются только плитка и две затронутые строки (или столбца).
+
+    static const int IDA_FOUND = -1;
+    static const int MAX_SOLUTION_LENGTH = 128;
+
+    struct IncrementalTables {
+        uint8_t manhattan[16][16];        // [плитка][клетка]
+        uint8_t rowConflicts[4][1 << 16]; // [строка][4 плитки строки]
+        uint8_t colConflicts[4][1 << 16]; // [столбец][4 плитки столбца]
+        int8_t blankMoves[16][4];         // клетка пустой после хода DIR_NAMES[d], -1 если нельзя
+    };
+
+    struct IdaContext {
+        const atomic<bool>* stop = nullptr; // параллельный IDA*: решение уже найдено другим потоком
+        bool use_pattern_db = false;
+        bool use_walking_distance = false;
+        uint8_t tile_pos[16]; // для базы шаблонов: клетка каждой плитки
+        int wd_row = 0, wd_col = 0; // для walking distance: состояния строк и столбцов
+        SearchStats stats;          // expanded - число посещённых узлов
+        int threshold = 0;
+        int solution_length = 0;
+        char path[MAX_SOLUTION_LENGTH];
+    };
+
+    static int lineConflicts(const int goal_coords[4], int count) {
+        // goal_coords - целевые позиции плиток своей линии в порядке их расположения
+        int lis[4];
+        int best = 0;
+        for (int i = 0; i < count; i++) {
+            lis[i] = 1;
+            for (int j = 0; j < i; j++) {
+                if (goal_coords[j] < goal_coords[i]) lis[i] = max(lis[i], lis[j] + 1);
+            }
+            best = max(best, lis[i]);
+        }
+        return 2 * (count - best);
+    }
+
+    static const IncrementalTables& incrementalTables() {
+        static const IncrementalTables* tables = [] {
+            IncrementalTables* t = new IncrementalTables();
+            for (int tile = 0; tile < 16; tile++) {
+                for (int pos = 0; pos < 16; pos++) {
+                    t->manhattan[tile][pos] = tile == 0 ? 0 :
+                        (uint8_t)(abs(pos / 4 - (tile - 1) / 4) + abs(pos % 4 - (tile - 1) % 4));
+                }
+            }
+            for (int line = 0; line < 4; line++) {
+                for (int key = 0; key < (1 << 16); key++) {
+                    int row_goals[4], row_count = 0;
+                    int col_goals[4], col_count = 0;
+                    for (int k = 0; k < 4; k++) {
+                        int tile = (key >> (12 - 4 * k)) & 0xF;
+                        if (tile == 0) continue;
+                        if ((tile - 1) / 4 == line) row_goals[row_count++] = (tile - 1) % 4;
+                        if ((tile - 1) % 4 == line) col_goals[col_count++] = (tile - 1) / 4;
+                    }
+                    t->rowConflicts[line][key] = (uint8_t)lineConflicts(row_goals, row_count);
+                    t->colConflicts[line][key] = (uint8_t)lineConflicts(col_goals, col_count);
+                }
+            }
+            const int dRow[4] = { -1, 0, 1, 0 };
+            const int dCol[4] = { 0, 1, 0, -1 };
+            for (int pos = 0; pos < 16; pos++) {
+                for (int dir = 0; dir < 4; dir++) {
+                    int row = pos / 4 + dRow[dir], col = pos % 4 + dCol[dir];
+                    t->blankMoves[pos][dir] = (row >= 0 && row < 4 && col >= 0 && col < 4) ? (int8_t)(row * 4 + col) : -1;
+                }
+            }
+            return t;
+        }();
+        return *tables;
+    }
+
+    static int rowKey(uint64_t state, int row) {
+        return (int)((state >> ((3 - row) * 16)) & 0xFFFF);
+    }
+
+    static int colKey(uint64_t state, int col) {
+        return (getTile(state, col) << 12) | (getTile(state, 4 + col) << 8) |
+            (getTile(state, 8 + col) << 4) | getTile(state, 12 + col);
+    }
+
+    int incrementalHeuristic(uint64_t state) {
+        const IncrementalTables& t = incrementalTables();
+        int h = 0;
+        for (int pos = 0; pos < TOTAL_CELLS; pos++) {
+            h += t.manhattan[getTile(state, pos)][pos];
+        }
+        for (int line = 0; line < SIZE; line++) {
+            h += t.rowConflicts[line][rowKey(state, line)] + t.colConflicts[line][colKey(state, line)];
+        }
+        return h;
+    }
+
+    // Изменение эвристики после переноса плитки из new_pos в empty_pos
+    static int heuristicDelta(const IncrementalTables& t, uint64_t before, uint64_t after,
+        int empty_pos, int new_pos, int dir) {
+        int tile = getTile(before, new_pos);
+        int delta = t.manhattan[tile][empty_pos] - t.manhattan[tile][new_pos];
+        if (dir == 0 || dir == 2) {
+            // вертикальный ход: плитка сменила строку, порядок в столбце не изменился
+            int r1 = empty_pos / 4, r2 = new_pos / 4;
+            delta += t.rowConflicts[r1][rowKey(after, r1)] - t.rowConflicts[r1][rowKey(before, r1)];
+            delta += t.rowConflicts[r2][rowKey(after, r2)] - t.rowConflicts[r2][rowKey(before, r2)];
+        }
+        else {
+            int c1 = empty_pos % 4, c2 = new_pos % 4;
+            delta += t.colConflicts[c1][colKey(after, c1)] - t.colConflicts[c1][colKey(before, c1)];
+            delta += t.colConflicts[c2][colKey(after, c2)] - t.colConflicts[c2][colKey(before, c2)];
+        }
+        return delta;
+    }
+
+    // Возвращает IDA_FOUND или минимальное f, превысившее порог
+    // h потомка после переноса плитки из new_pos в empty_pos. Для базы шаблонов
+    // обновляет ctx.tile_pos, вызывающий восстанавливает клетку плитки сам.
+    int childHeuristic(IdaContext& ctx, const IncrementalTables& t, uint64_t state, uint64_t next,
+        int h, int empty_pos, int new_pos, int dir) {
+        if (ctx.use_pattern_db) {
+            // меняется только значение группы сдвинутой плитки
+            int tile = getTile(state, new_pos);
+            int group = patternDb->groupOf(tile);
+            int new_h = h - patternDb->groupValue(group, ctx.tile_pos);
+            ctx.tile_pos[tile] = (uint8_t)empty_pos;
+            return new_h + patternDb->groupValue(group, ctx.tile_pos);
+        }
+        if (ctx.use_walking_distance) {
+            // вертикальный ход меняет только состояние строк, горизонтальный - столбцов
+            const WalkingDistanceTable& wd = walkingDistanceTable();
+            int tile = getTile(state, new_pos);
+            if (dir == 0 || dir == 2) ctx.wd_row = wd.next[ctx.wd_row * 8 + (dir == 0 ? 0 : 4) + (tile - 1) / 4];
+            else ctx.wd_col = wd.next[ctx.wd_col * 8 + (dir == 3 ? 0 : 4) + (tile - 1) % 4];
+            return wd.distance[ctx.wd_row] + wd.distance[ctx.wd_col];
+        }
+        return h + heuristicDelta(t, state, next, empty_pos, new_pos, dir);
+    }
+
+    // h корня IDA*: выбирает эвристику и заполняет её состояние в ctx
+    int idaRootHeuristic(IdaContext& ctx, uint64_t state) {
+        ctx.use_pattern_db = usePatternDb();
+        ctx.use_walking_distance = !ctx.use_pattern_db && heuristic == Heuristic::WalkingDistance;
+        fillTilePositions(state, ctx.tile_pos);
+        if (ctx.use_pattern_db) return patternDb->lookup(ctx.tile_pos);
+        if (ctx.use_walking_distance) {
+            const WalkingDistanceTable& wd = walkingDistanceTable();
+            ctx.wd_row = walkingIndex(state, false);
+            ctx.wd_col = walkingIndex(state, true);
+            return wd.distance[ctx.wd_row] + wd.distance[ctx.wd_col];
+        }
+        return incrementalHeuristic(state);
+    }
+
+    int idaSearch(IdaContext& ctx, uint64_t state, int empty_pos, int g, int h, int prev_dir) {
+        ctx.stats.expanded++;
+        if (ctx.stop != nullptr && ctx.stop->load(memory_order_relaxed)) return INT_MAX;
+        int f = g + h;
+        if (f > ctx.threshold) {
+            ctx.stats.cutoffs++;
+            return f;
+        }
+        if (state == GOAL_PACKED) {
+            ctx.solution_length = g;
+            return IDA_FOUND;
+        }
+
+        const IncrementalTables& t = incrementalTables();
+        int wd_row = ctx.wd_row, wd_col = ctx.wd_col;
+        int min_next = INT_MAX;
+        for (int dir = 0; dir < 4; dir++) {
+            if (prev_dir >= 0 && dir == (prev_dir + 2) % 4) continue; // не отменяем ход родителя
+            int new_pos = t.blankMoves[empty_pos][dir];
+            if (new_pos < 0) continue;
+
+            uint64_t next = moveTile(state, empty_pos, new_pos);
+            int tile = getTile(state, new_pos);
+            int new_h;
+            {
+                PhaseTimer timer(ctx.stats.timePhases, ctx.stats.heuristicMs);
+                new_h = childHeuristic(ctx, t, state, next, h, empty_pos, new_pos, dir);
+            }
+            ctx.stats.generated++;
+            ctx.stats.heuristicEvaluations++;
+            ctx.path[g] = DIR_NAMES[dir];
+
+            int result = idaSearch(ctx, next, new_pos, g + 1, new_h, dir);
+            if (ctx.use_pattern_db) ctx.tile_pos[tile] = (uint8_t)new_pos;
+            ctx.wd_row = wd_row;
+            ctx.wd_col = wd_col;
+            if (result == IDA_FOUND) return IDA_FOUND;
+            min_next = min(min_next, result);
+        }
+        return min_next;
+    }
+
+    // ========== Параллельный IDA* ==========
+    // Первые ходы дерева раскрываются заранее в единицы работы. На каждом пороге потоки
+    // разбирают единицы через общий счётчик; итерация прекращается, как только кто-то
+    // нашёл решение. Все решения итерации с порогом t имеют длину ровно t, поэтому
+    // первое найденное решение оптимально.
+
+    static const int MAX_SPLIT_DEPTH = 12;
+
+    struct IdaWorkUnit {
+        uint64_t state;
+        int empty_pos;
+        int g;
+        int h;
+        int prev_dir;
+        uint8_t tile_pos[16];
+        int wd_row, wd_col;
+        char path[MAX_SPLIT_DEPTH];
+    };
+
+    // Раскрывает дерево по уровням, пока единиц работы меньше min_units.
+    // Если цель встретилась на одном из уровней, её путь кратчайший и возвращается в goal_path.
+    vector<IdaWorkUnit> splitIdaTree(const IdaWorkUnit& root, const IdaContext& settings, size_t min_units, string& goal_path) {
+        const IncrementalTables& t = incrementalTables();
+        vector<IdaWorkUnit> frontier(1, root), next_level;
+        IdaContext ctx;
+        ctx.use_pattern_db = settings.use_pattern_db;
+        ctx.use_walking_distance = settings.use_walking_distance;
+
+        while (frontier.size() < min_units && frontier[0].g < MAX_SPLIT_DEPTH) {
+            next_level.clear();
+            for (const IdaWorkUnit& unit : frontier) {
+                for (int dir = 0; dir < 4; dir++) {
+                    if (unit.prev_dir >= 0 && dir == (unit.prev_dir + 2) % 4) continue;
+                    int new_pos = t.blankMoves[unit.empty_pos][dir];
+                    if (new_pos < 0) continue;
+
+                    IdaWorkUnit child = unit;
+                    memcpy(ctx.tile_pos, unit.tile_pos, sizeof(ctx.tile_pos));
+                    ctx.wd_row = unit.wd_row;
+                    ctx.wd_col = unit.wd_col;
+                    child.state = moveTile(unit.state, unit.empty_pos, new_pos);
+                    child.h = childHeuristic(ctx, t, unit.state, child.state, unit.h, unit.empty_pos, new_pos, dir);
+                    memcpy(child.tile_pos, ctx.tile_pos, sizeof(child.tile_pos));
+                    child.wd_row = ctx.wd_row;
+                    child.wd_col = ctx.wd_col;
+                    child.empty_pos = new_pos;
+                    child.prev_dir = dir;
+                    child.path[unit.g] = DIR_NAMES[dir];
+                    child.g = unit.g + 1;
+
+                    if (child.state == GOAL_PACKED) {
+                        goal_path.assign(child.path, child.g);
+                        return {};
+                    }
+                    next_level.push_back(child);
+                }
+            }
+            frontier.swap(next_level);
+        }
+        return frontier;
+    }
+
 public:
 
+    void setHeuristic(Heuristic type) { heuristic = type; }
+
+    void setPatternDatabase(const PatternDatabase* db) { patternDb = db; }
+
+    void setVerbose(bool value) { verbose = value; }
+
+    long long getLastStatesVisited() const { return stats.expanded; }
+
+    const SearchStats& getLastStats() const { return stats; }
+
+    // Замер времени эвристики и генерации ходов (замедляет поиск)
+    void setPhaseTiming(bool value) { stats.timePhases = value; }
+
     bool isSolvable(const string& state) {
         int sumN = 0;
         int emptyRow = 0;
@@ -233,7 +1030,7 @@ public:
 
     bool isValidInput(const string& input) {
         if (input.length() != TOTAL_CELLS) {
-            cout << "ERROR need 16 symbols" << endl;
+            if (verbose) cout << "ERROR need 16 symbols" << endl;
             return false;
         }
 
@@ -242,11 +1039,11 @@ public:
         for (char c : input) {
             int val = hexCharToInt(c);
             if (val == -1) {
-                cout << "ERROR not available symbol '" << c << "'." << endl;
+                if (verbose) cout << "ERROR not available symbol '" << c << "'." << endl;
                 return false;
             }
             if (found[val]) {
-                cout << "ERROR symbol '" << c << "' is not unique" << endl;
+                if (verbose) cout << "ERROR symbol '" << c << "' is not unique" << endl;
                 return false;
             }
             found[val] = true;
@@ -255,7 +1052,7 @@ public:
 
         for (int i = 0; i < TOTAL_CELLS; i++) {
             if (!found[i]) {
-                cout << "ERROR miss symbol in input " << i << endl;
+                if (verbose) cout << "ERROR miss symbol in input " << i << endl;
                 return false;
             }
         }
@@ -265,32 +1062,38 @@ public:
 
     string solveBFS(const string& initial) {
         int empty_pos = initial.find('0');
-        queue<Node> q;
-        unordered_map<string, bool> visited;
+        uint64_t start = packState(initial);
+        vector<Node> nodes; // узлы в порядке добавления, они же очередь BFS
+        FlatStateSet<uint64_t> visited(1 << 16);
+        Neighbors neighbors;
 
-        q.push(Node(initial, "", empty_pos));
-        visited[initial] = true;
+        nodes.push_back(Node(start, empty_pos));
+        visited.insert(start);
 
         int states_visited = 0;
 
-        while (!q.empty()) {
-            Node current = q.front();
-            q.pop();
+        for (uint32_t head = 0; head < nodes.size(); head++) {
+            Node current = nodes[head];
             states_visited++;
+            stats.expanded++;
+            stats.noteOpenSize(nodes.size() - head);
 
-            if (current.state == GOAL) {
-                cout << "BFS visited states: " << states_visited << endl;
+            if (current.state == GOAL_PACKED) {
+                if (verbose) cout << "BFS visited states: " << states_visited << endl;
                 if (states_visited == 1) {
                     return "-";
                 }
-                return current.path;
+                return buildPath(nodes, head);
             }
 
-            vector<Node> neighbors = getNeighbors(current);
-            for (const Node& neighbor : neighbors) {
-                if (!visited[neighbor.state]) {
-                    visited[neighbor.state] = true;
-                    q.push(neighbor);
+            expandNode(current, neighbors);
+            for (Node neighbor : neighbors) {
+                if (visited.insert(neighbor.state).second) {
+                    neighbor.parent = head;
+                    nodes.push_back(neighbor);
+                }
+                else {
+                    stats.duplicates++;
                 }
             }
         }
@@ -298,43 +1101,125 @@ public:
         return "";
     }
 
+    // Двунаправленный поиск в ширину: слои наращиваются попеременно от начального состояния
+    // и от GOAL (расширяется меньший фронт) до встречи фронтов. Встреча проверяется при
+    // порождении узла, слой дорабатывается до конца, чтобы выбрать кратчайший путь.
+    string solveBidirectionalBFS(const string& initial) {
+        if (!isSolvable(initial)) return "";
+        if (initial == GOAL) return "-";
+
+        // Сторона поиска: узлы в порядке добавления и индекс узла по состоянию
+        struct Side {
+            vector<Node> nodes;
+            FlatStateTable<uint64_t, uint32_t> index;
+            size_t level_start = 0;
+            Side() : index(1 << 16) {}
+        };
+        Side forward, backward;
+
+        forward.nodes.push_back(Node(packState(initial), (int)initial.find('0')));
+        forward.index[forward.nodes[0].state] = 0;
+        backward.nodes.push_back(Node(GOAL_PACKED, TOTAL_CELLS - 1));
+        backward.index[GOAL_PACKED] = 0;
+
+        int best = INT_MAX;
+        uint32_t best_forward = 0, best_backward = 0;
+        long long states_visited = 0;
+        Neighbors neighbors;
+
+        while (best == INT_MAX) {
+            bool expand_forward = forward.nodes.size() - forward.level_start <= backward.nodes.size() - backward.level_start;
+            Side& side = expand_forward ? forward : backward;
+            Side& other = expand_forward ? backward : forward;
+            size_t level_end = side.nodes.size();
+            if (side.level_start == level_end) break;
+            stats.noteOpenSize(level_end - side.level_start + other.nodes.size() - other.level_start);
+
+            for (size_t i = side.level_start; i < level_end; i++) {
+                Node current = side.nodes[i];
+                states_visited++;
+                stats.expanded++;
+
+                expandNode(current, neighbors);
+                for (Node neighbor : neighbors) {
+                    if (!side.index.insert(neighbor.state, (uint32_t)side.nodes.size()).second) {
+                        stats.duplicates++;
+                        continue;
+                    }
+                    neighbor.parent = (uint32_t)i;
+                    side.nodes.push_back(neighbor);
+
+                    const uint32_t* met = other.index.find(neighbor.state);
+                    if (met != nullptr && neighbor.g + other.nodes[*met].g < best) {
+                        best = neighbor.g + other.nodes[*met].g;
+                        best_forward = expand_forward ? (uint32_t)side.nodes.size() - 1 : *met;
+                        best_backward = expand_forward ? *met : (uint32_t)side.nodes.size() - 1;
+                    }
+                }
+            }
+            side.level_start = level_end;
+        }
+
+        if (verbose) cout << "Bidirectional BFS visited states: " << states_visited << endl;
+        if (best == INT_MAX) return "";
+
+        // Вторая половина пути: от точки встречи к цели ходы обратной стороны инвертируются
+        string path = buildPath(forward.nodes, best_forward);
+        for (uint32_t index = best_backward; backward.nodes[index].parent != NO_PARENT; index = backward.nodes[index].parent) {
+            path += DIR_NAMES[(backward.nodes[index].move + 2) % 4];
+        }
+        return path;
+    }
+
     string solveDFS(const string& initial, int depth_limit, int& states_visited, bool printInfo = true) {
         int empty_pos = initial.find('0');
-        stack<Node> s;
-        unordered_map<string, int> visited; // храним глубину посещения
-
-        s.push(Node(initial, "", empty_pos));
-        visited[initial] = 0;
+        uint64_t start = packState(initial);
+        vector<Node> nodes;
+        stack<uint32_t> s;
+        FlatStateTable<uint64_t, int> visited(1 << 16); // храним глубину посещения
+        Neighbors neighbors;
+
+        nodes.push_back(Node(start, empty_pos));
+        s.push(0);
+        visited[start] = 0;
         states_visited = 0;
 
         while (!s.empty()) {
-            Node current = s.top();
+            uint32_t index = s.top();
+            Node current = nodes[index];
             s.pop();
             states_visited++;
+            stats.expanded++;
 
-            if (current.state == GOAL) {
+            if (current.state == GOAL_PACKED) {
                 if (printInfo) {
-                    cout << "DFS visited states: " << states_visited << endl;
+                    if (verbose) cout << "DFS visited states: " << states_visited << endl;
                 }
                 if (states_visited == 1) {
                     return "-";
                 }
-                return current.path;
+                return buildPath(nodes, index);
             }
 
             // Пропускаем если превысили глубину
-            if (current.path.length() >= depth_limit) {
+            if (current.g >= depth_limit) {
                 continue;
             }
 
-            vector<Node> neighbors = getNeighbors(current);
-            for (const Node& neighbor : neighbors) {
-                auto it = visited.find(neighbor.state);
-                if (it == visited.end() || it->second > neighbor.path.length()) {
-                    visited[neighbor.state] = neighbor.path.length();
-                    s.push(neighbor);
+            expandNode(current, neighbors);
+            for (Node neighbor : neighbors) {
+                int* depth = visited.find(neighbor.state);
+                if (depth == nullptr || *depth > neighbor.g) {
+                    visited[neighbor.state] = neighbor.g;
+                    neighbor.parent = index;
+                    s.push((uint32_t)nodes.size());
+                    nodes.push_back(neighbor);
+                }
+                else {
+                    stats.duplicates++;
                 }
             }
+            stats.noteOpenSize(s.size());
         }
 
         return "";
@@ -350,7 +1235,7 @@ public:
             total_states += states_visited;
 
             if (!result.empty()) {
-                cout << "IDS visited states: " << total_states << endl;
+                if (verbose) cout << "IDS visited states: " << total_states << endl;
                 return result;
             }
 
@@ -360,127 +1245,243 @@ public:
     }
 
     string solveAStar(const string& initial) {
-        if (initial == GOAL) return "-";
+        BucketOpenList open_set;
+        return aStarSearch(initial, open_set);
+    }
 
-        int empty_pos = initial.find('0');
+    string solveAStarHeap(const string& initial) {
+        HeapOpenList open_set;
+        return aStarSearch(initial, open_set);
+    }
 
-        priority_queue<Node, vector<Node>, greater<Node>> open_set;
-        unordered_map<string, int> best_g; // храним только лучший g для каждого состояния
+    // Сравнение открытых списков A*: число состояний, пик открытого списка и его память
+    void compareOpenLists(string& input) {
+        if (!processInput(input)) {
+            return;
+        }
+        bool old_verbose = verbose;
+        verbose = false;
 
-        int h0 = combinedHeuristic(initial);
-        open_set.push(Node(initial, "", empty_pos, 0, h0));
-        best_g[initial] = 0;
+        HeapOpenList heap;
+        stats.begin();
+        auto start = high_resolution_clock::now();
+        string heap_solution = aStarSearch(input, heap);
+        long long heap_ms = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
+        long long heap_states = stats.expanded;
+
+        BucketOpenList buckets;
+        stats.begin();
+        start = high_resolution_clock::now();
+        string bucket_solution = aStarSearch(input, buckets);
+        long long bucket_ms = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
+        long long bucket_states = stats.expanded;
+
+        verbose = old_verbose;
+        cout << "Heap   : length " << heap_solution.length() << ", states " << heap_states
+            << ", open peak " << heap.peakSize() << ", open memory " << heap.memoryBytes() / 1024
+            << " KB, time " << heap_ms << " ms" << endl;
+        cout << "Buckets: length " << bucket_solution.length() << ", states " << bucket_states
+            << ", open peak " << buckets.peakSize() << ", open memory " << buckets.memoryBytes() / 1024
+            << " KB, time " << bucket_ms << " ms" << endl;
+    }
 
-        int states_visited = 0;
+    // Сравнение эвристик: Манхэттен + конфликты против walking distance, h корня и IDA*
+    void compareHeuristics(string& input) {
+        if (!processInput(input)) {
+            return;
+        }
+        bool old_verbose = verbose;
+        Heuristic old_heuristic = heuristic;
+        verbose = false;
+        uint64_t state = packState(input);
+
+        const Heuristic types[2] = { Heuristic::Default, Heuristic::WalkingDistance };
+        const char* names[2] = { "Manhattan + conflicts", "Walking distance     " };
+        for (int i = 0; i < 2; i++) {
+            heuristic = types[i];
+            IdaContext root;
+            int root_h = idaRootHeuristic(root, state); // та же оценка корня, что и у IDA* ниже
+            stats.begin();
+            auto start = high_resolution_clock::now();
+            string solution = solveIDAStar(input);
+            long long ms = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
+            cout << names[i] << ": root h " << root_h << ", IDA* length " << solution.length()
+                << ", states " << stats.expanded << ", time " << ms << " ms" << endl;
+        }
 
-        while (!open_set.empty()) {
-            Node current = open_set.top();
-            open_set.pop();
-            states_visited++;
+        heuristic = old_heuristic;
+        verbose = old_verbose;
+    }
 
-            if (current.g > best_g[current.state]) {
-                continue;
-            }
+    string solveIDAStar(const string& initial) {
+        if (initial == GOAL) return "-";
+
+        int empty_pos = initial.find('0');
+        uint64_t start = packState(initial);
+        IdaContext ctx;
+        ctx.stats.timePhases = stats.timePhases;
+        int h0 = idaRootHeuristic(ctx, start);
+        ctx.threshold = h0;
+        string solution;
 
-            if (current.state == GOAL) {
-                cout << "A* visited states: " << states_visited << endl;
-                return current.path;
+        while (ctx.threshold < MAX_SOLUTION_LENGTH) {
+            int result = idaSearch(ctx, start, empty_pos, 0, h0, -1);
+            if (result == IDA_FOUND) {
+                if (verbose) cout << "IDA* total visited states: " << ctx.stats.expanded << endl;
+                solution.assign(ctx.path, ctx.solution_length);
+                break;
             }
+            if (result == INT_MAX) {
+                if (verbose) cout << "IDA*: No solution exists" << endl;
+                break;
+            }
+            ctx.threshold = result;
+        }
 
-            vector<Node> neighbors = getNeighbors(current);
-            for (const Node& neighbor : neighbors) {
-                int new_g = current.g + 1;
-                auto it = best_g.find(neighbor.state);
+        stats.merge(ctx.stats);
+        return solution;
+    }
 
-                if (it == best_g.end() || new_g < it->second) {
-                    best_g[neighbor.state] = new_g;
-                    int new_h = combinedHeuristic(neighbor.state);
-                    open_set.push(Node(neighbor.state, neighbor.path, neighbor.empty_pos, new_g, new_h));
+    string solveParallelIDAStar(const string& initial, int threads = 0) {
+        if (initial == GOAL) return "-";
+        if (threads <= 0) threads = max(1, (int)thread::hardware_concurrency());
+
+        IdaWorkUnit root;
+        root.state = packState(initial);
+        root.empty_pos = initial.find('0');
+        root.g = 0;
+        root.prev_dir = -1;
+        IdaContext settings;
+        root.h = idaRootHeuristic(settings, root.state);
+        memcpy(root.tile_pos, settings.tile_pos, sizeof(root.tile_pos));
+        root.wd_row = settings.wd_row;
+        root.wd_col = settings.wd_col;
+
+        string goal_path;
+        vector<IdaWorkUnit> units = splitIdaTree(root, settings, (size_t)threads * 16, goal_path);
+        if (!goal_path.empty()) {
+            if (verbose) cout << "Parallel IDA* found the goal while splitting the tree" << endl;
+            return goal_path;
+        }
+
+        mutex stats_lock;
+        int threshold = root.h;
+
+        while (threshold < MAX_SOLUTION_LENGTH) {
+            atomic<size_t> next_unit(0);
+            atomic<bool> found(false);
+            atomic<int> next_threshold(INT_MAX);
+            mutex solution_lock;
+            string solution;
+
+            auto worker = [&]() {
+                IdaContext ctx;
+                ctx.stop = &found;
+                ctx.use_pattern_db = settings.use_pattern_db;
+                ctx.use_walking_distance = settings.use_walking_distance;
+                ctx.stats.timePhases = stats.timePhases;
+                ctx.threshold = threshold;
+                for (size_t i = next_unit++; i < units.size() && !found.load(); i = next_unit++) {
+                    const IdaWorkUnit& unit = units[i];
+                    memcpy(ctx.tile_pos, unit.tile_pos, sizeof(ctx.tile_pos));
+                    ctx.wd_row = unit.wd_row;
+                    ctx.wd_col = unit.wd_col;
+                    memcpy(ctx.path, unit.path, unit.g);
+                    int result = idaSearch(ctx, unit.state, unit.empty_pos, unit.g, unit.h, unit.prev_dir);
+                    if (result == IDA_FOUND) {
+                        lock_guard<mutex> guard(solution_lock);
+                        if (!found.load()) {
+                            solution.assign(ctx.path, ctx.solution_length);
+                            found.store(true);
+                        }
+                        break;
+                    }
+                    int current = next_threshold.load();
+                    while (result < current && !next_threshold.compare_exchange_weak(current, result)) {
+                    }
                 }
+                lock_guard<mutex> guard(stats_lock);
+                stats.merge(ctx.stats);
+            };
+
+            vector<thread> pool;
+            for (int i = 0; i < threads; i++) pool.emplace_back(worker);
+            for (thread& t : pool) t.join();
+
+            if (found.load()) {
+                if (verbose) cout << "Parallel IDA* total visited states: " << stats.expanded
+                    << " (" << threads << " threads, " << units.size() << " work units)" << endl;
+                return solution;
             }
-
-            if (states_visited > 10000000) {
-                cout << "A*: State limit reached" << endl;
+            if (next_threshold.load() == INT_MAX) {
+                if (verbose) cout << "Parallel IDA*: No solution exists" << endl;
                 break;
             }
+            threshold = next_threshold.load();
         }
 
         return "";
     }
 
-    string solveIDAStar(const string& initial) {
+    template <class OpenList>
+    string aStarSearch(const string& initial, OpenList& open_set) {
         if (initial == GOAL) return "-";
 
-        int stateLim = 10000000;
         int empty_pos = initial.find('0');
-        int threshold = combinedHeuristic(initial);
-
-        int total_states = 0;
-
-        while (true) {
-            unordered_map<string, int> visited;
-            stack<Node> s;
-
-            int h = combinedHeuristic(initial);
-            s.push(Node(initial, "", empty_pos, 0, h));
-            visited[initial] = 0;
+        uint64_t start = packState(initial);
 
-            int states_visited = 0;
-            int next_threshold = INT_MAX;
-
-            while (!s.empty() && states_visited < stateLim) {
-                Node current = s.top();
-                s.pop();
-                states_visited++;
+        vector<Node> nodes;
+        FlatStateTable<uint64_t, int> best_g(1 << 20); // храним только лучший g для каждого состояния
+        Neighbors neighbors;
 
-                if (current.state == GOAL) {
-                    total_states += states_visited;
-                    cout << "IDA* total visited states: " << total_states << endl;
-                    //cout << "Solution found with threshold: " << threshold << endl;
-                    return current.path;
-                }
+        int h0 = aStarHeuristic(start);
+        nodes.push_back(Node(start, empty_pos, NO_PARENT, 0, 0, h0));
+        open_set.push(h0, 0, 0);
+        best_g[start] = 0;
 
-                if (current.f() > threshold) {
-                    next_threshold = min(next_threshold, current.f());
-                    continue;
-                }
+        int states_visited = 0;
 
-                vector<Node> neighbors = getNeighbors(Node(current.state, current.path, current.empty_pos));
-                for (const Node& neighbor : neighbors) {
-                    int new_g = current.g + 1;
+        while (!open_set.empty()) {
+            uint32_t index = open_set.pop();
+            Node current = nodes[index];
+            states_visited++;
 
-                    auto it = visited.find(neighbor.state);
-                    if (it == visited.end() || new_g < it->second) {
-                        int new_h = combinedHeuristic(neighbor.state);
-                        int new_f = new_g + new_h;
+            if (current.g > best_g[current.state]) {
+                stats.duplicates++; // устаревшая запись открытого списка
+                continue;
+            }
+            stats.expanded++;
 
-                        if (new_f <= threshold) {
-                            visited[neighbor.state] = new_g;
-                            s.push(Node(neighbor.state, neighbor.path, neighbor.empty_pos, new_g, new_h));
-                        }
-                        else {
-                            next_threshold = min(next_threshold, new_f);
-                        }
-                    }
-                }
+            if (current.state == GOAL_PACKED) {
+                if (verbose) cout << "A* visited states: " << states_visited << endl;
+                stats.noteOpenSize(open_set.peakSize());
+                return buildPath(nodes, index);
             }
 
-            total_states += states_visited;
+            expandNode(current, neighbors);
+            for (Node neighbor : neighbors) {
+                int new_g = current.g + 1;
+                int* old_g = best_g.find(neighbor.state);
 
-            if (next_threshold == INT_MAX) {
-                cout << "IDA*: No solution exists" << endl;
-                break;
+                if (old_g == nullptr || new_g < *old_g) {
+                    best_g[neighbor.state] = new_g;
+                    neighbor.h = (uint8_t)aStarHeuristic(neighbor.state);
+                    neighbor.parent = index;
+                    open_set.push(neighbor.f(), new_g, (uint32_t)nodes.size());
+                    nodes.push_back(neighbor);
+                }
+                else {
+                    stats.duplicates++;
+                }
             }
 
-            threshold = next_threshold;
-
-            if (total_states > stateLim) {
-                cout << "IDA*: Total state limit reached" << endl;
+            if (states_visited > 10000000) {
+                if (verbose) cout << "A*: State limit reached" << endl;
                 break;
             }
-
         }
 
+        stats.noteOpenSize(open_set.peakSize());
         return "";
     }
 
@@ -554,39 +1555,49 @@ public:
             return false;
         }
         if (!isSolvable(input)) {
-            cout << "ERROR Unsolvable position!" << endl;
+            if (verbose) cout << "ERROR Unsolvable position!" << endl;
             return false;
         }
         return true;
     }
 
-    void printSolution(string& input, int typeSol) {// 0-BFS 1-DFS 2-IDS
-        if (!processInput(input)) {
-            return;
-        }
-
-        string solution;
-        auto start = high_resolution_clock::now();
+    // Решение выбранным алгоритмом, вход уже проверен processInput.
+    // Счётчики поиска, время и пик памяти доступны через getLastStats()
+    string solve(const string& input, int typeSol) {
+        stats.begin();
+        string solution = runSolver(input, typeSol);
+        stats.finish();
+        return solution;
+    }
 
+    string runSolver(const string& input, int typeSol) {
         switch (typeSol) {
         case 0:
-            solution = solveBFS(input);
-            break;
+            return solveBFS(input);
         case 1:
             int states;
-            solution = solveDFS(input, 30, states);
-            break;
+            return solveDFS(input, 30, states);
         case 2:
-            solution = solveIDS(input);
-            break;
+            return solveIDS(input);
         case 3: // A*
-            solution = solveAStar(input);
-            break;
+            return solveAStar(input);
         case 4: // IDA*
-            solution = solveIDAStar(input);
-            break;
+            return solveIDAStar(input);
+        case 5: // параллельный IDA*
+            return solveParallelIDAStar(input);
+        case 6: // двунаправленный BFS
+            return solveBidirectionalBFS(input);
+        }
+        return "";
+    }
+
+    void printSolution(string& input, int typeSol) {// 0-BFS 1-DFS 2-IDS 3-A* 4-IDA* 5-параллельный IDA* 6-двунаправленный BFS
+        if (!processInput(input)) {
+            return;
         }
 
+        auto start = high_resolution_clock::now();
+        string solution = solve(input, typeSol);
         auto stop = high_resolution_clock::now();
         auto duration = duration_cast<milliseconds>(stop - start);
 
@@ -599,6 +1610,7 @@ public:
 
             replaySolution(input, solution, "solution.txt");
         }
+        cout << "Stats: " << stats.toJson() << endl;
 
     }
 
@@ -621,6 +1633,8 @@ public:
         printBoard(input);
         cout << "=== BFS ===" << endl;
         printSolution(input, 0);
+        cout << "=== Bidirectional BFS ===" << endl;
+        printSolution(input, 6);
         cout << "=== IDS ===" << endl;
         printSolution(input, 2);
         cout << "=== A* ===" << endl;
@@ -636,14 +1650,349 @@ public:
         printSolution(input, 3);
         cout << "=== IDA* ===" << endl;
         printSolution(input, 4);
+        cout << "=== Parallel IDA* ===" << endl;
+        printSolution(input, 5);
         cout << endl;
     }
 };
 
-int main() {
+// ========== Пакетный режим ==========
+// Пул потоков с захватом работы: у каждого потока своя очередь задач, освободившийся поток
+// забирает задачи с хвоста чужих очередей, поэтому долгие позиции не задерживают остальные.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threads) : queues(max(threads, 1)) {}
+
+    void run(size_t taskCount, const function<void(int, size_t)>& task) {
+        for (size_t i = 0; i < taskCount; i++) {
+            queues[i % queues.size()].tasks.push_back(i);
+        }
+        vector<thread> workers;
+        for (int w = 0; w < (int)queues.size(); w++) {
+            workers.emplace_back([this, w, &task] { workerLoop(w, task); });
+        }
+        for (thread& worker : workers) worker.join();
+    }
+
+private:
+    struct TaskQueue {
+        mutex lock;
+        deque<size_t> tasks;
+    };
+    vector<TaskQueue> queues;
+
+    bool popLocal(int worker, size_t& task) {
+        lock_guard<mutex> guard(queues[worker].lock);
+        if (queues[worker].tasks.empty()) return false;
+        task = queues[worker].tasks.front();
+        queues[worker].tasks.pop_front();
+        return true;
+    }
+
+    bool steal(int worker, size_t& task) {
+        int n = (int)queues.size();
+        for (int offset = 1; offset < n; offset++) {
+            TaskQueue& victim = queues[(worker + offset) % n];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Новые задачи не появляются, поэтому поток завершается, когда все очереди пусты
+    void workerLoop(int worker, const function<void(int, size_t)>& task) {
+        size_t current;
+        while (popLocal(worker, current) || steal(worker, current)) {
+            task(worker, current);
+        }
+    }
+};
+
+struct BatchOptions {
+    string inputFile = "-";   // "-" - стандартный ввод
+    string outputFile = "-";
+    string format = "csv";    // csv или json
+    int threads = 0;          // 0 - по числу ядер
+    int typeSol = 4;
+    bool usePatternDb = false;
+    bool phaseTiming = false; // замер времени эвристики и генерации ходов в статистике
+};
+
+struct BatchResult {
+    string board;
+    string status;   // solved, not_found, invalid, unsolvable
+    string solution;
+    long long nodes = 0;
+    long long ms = 0;
+    SearchStats stats;
+};
+
+// Строка JSON в кавычках: кавычки, обратная косая черта и управляющие символы экранируются
+static string jsonString(const string& value) {
+    string escaped = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') escaped += '\\', escaped += c;
+        else if (c == '\n') escaped += "\\n";
+        else if (c == '\r') escaped += "\\r";
+        else if (c == '\t') escaped += "\\t";
+        else if ((unsigned char)c < 0x20) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", (unsigned char)c);
+            escaped += code;
+        }
+        else escaped += c;
+    }
+    return escaped + "\"";
+}
+
+// Поле CSV: поле с запятой, кавычкой или переводом строки берётся в кавычки, кавычки удваиваются
+static string csvField(const string& value) {
+    if (value.find_first_of(",\"\r\n") == string::npos) return value;
+    string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static void writeBatchResults(const vector<BatchResult>& results, const BatchOptions& options, ostream& out) {
+    if (options.format == "json") {
+        out << "[" << endl;
+        for (size_t i = 0; i < results.size(); i++) {
+            const BatchResult& r = results[i];
+            int length = r.solution == "-" ? 0 : (int)r.solution.length();
+            out << "  {\"board\": " << jsonString(r.board) << ", \"status\": " << jsonString(r.status)
+                << ", \"length\": " << length << ", \"nodes\": " << r.nodes
+                << ", \"ms\": " << r.ms << ", \"solution\": " << jsonString(r.solution)
+                << ", \"stats\": " << r.stats.toJson() << "}"
+                << (i + 1 < results.size() ? "," : "") << endl;
+        }
+        out << "]" << endl;
+    }
+    else {
+        out << "board,status,length,nodes,ms,solution" << endl;
+        for (const BatchResult& r : results) {
+            int length = r.solution == "-" ? 0 : (int)r.solution.length();
+            out << csvField(r.board) << "," << r.status << "," << length << "," << r.nodes << ","
+                << r.ms << "," << csvField(r.solution) << endl;
+        }
+    }
+}
+
+// Читает позиции (по одной в строке, '#' - комментарий), решает их в пуле потоков
+// и пишет длину решения, число состояний и время для каждой позиции
+static int runBatch(const BatchOptions& options, const PatternDatabase* pdb) {
+    vector<string> boards;
+    ifstream file;
+    istream* in = &cin;
+    if (options.inputFile != "-") {
+        file.open(options.inputFile);
+        if (!file.is_open()) {
+            cerr << "Cannot open file " << options.inputFile << endl;
+            return 1;
+        }
+        in = &file;
+    }
+    string line;
+    while (getline(*in, line)) {
+        line.erase(remove_if(line.begin(), line.end(), [](char c) { return isspace((unsigned char)c); }), line.end());
+        if (line.empty() || line[0] == '#') continue;
+        boards.push_back(line);
+    }
+
+    int threads = options.threads > 0 ? options.threads : (int)thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+
+    // у каждого потока свой решатель, общая только база шаблонов (только чтение)
+    vector<unique_ptr<Puzzle15Solver>> solvers;
+    for (int i = 0; i < threads; i++) {
+        solvers.emplace_back(new Puzzle15Solver());
+        solvers.back()->setVerbose(false);
+        solvers.back()->setPhaseTiming(options.phaseTiming);
+        if (options.usePatternDb && pdb != nullptr) {
+            solvers.back()->setPatternDatabase(pdb);
+            solvers.back()->setHeuristic(Puzzle15Solver::Heuristic::PatternDatabase);
+        }
+    }
+
+    vector<BatchResult> results(boards.size());
+    auto batchStart = steady_clock::now();
+
+    WorkStealingPool pool(threads);
+    pool.run(boards.size(), [&](int worker, size_t task) {
+        Puzzle15Solver& solver = *solvers[worker];
+        BatchResult& result = results[task];
+        string input = boards[task];
+        result.board = input;
+
+        if (!solver.processInput(input)) {
+            result.status = solver.isValidInput(input) ? "unsolvable" : "invalid";
+            return;
+        }
+
+        auto start = steady_clock::now();
+        result.solution = solver.solve(input, options.typeSol);
+        result.ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+        result.nodes = solver.getLastStatesVisited();
+        result.stats = solver.getLastStats();
+        result.status = result.solution.empty() ? "not_found" : "solved";
+        });
+
+    auto totalMs = duration_cast<milliseconds>(steady_clock::now() - batchStart).count();
+
+    if (options.outputFile == "-") {
+        writeBatchResults(results, options, cout);
+    }
+    else {
+        ofstream out(options.outputFile);
+        if (!out.is_open()) {
+            cerr << "Cannot open file " << options.outputFile << endl;
+            return 1;
+        }
+        writeBatchResults(results, options, out);
+    }
+    cerr << "Batch: " << boards.size() << " positions, " << threads << " threads, " << totalMs << " ms" << endl;
+    return 0;
+}
+
+// Целое число аргумента командной строки в диапазоне [low, high]
+static bool parseIntArg(const string& text, int low, int high, int& value) {
+    char* end = nullptr;
+    errno = 0;
+    long parsed = strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || errno == ERANGE || parsed < low || parsed > high) return false;
+    value = (int)parsed;
+    return true;
+}
+
+// Загрузка базы шаблонов из файла, при отсутствии файла - построение и сохранение
+static void loadPatternDatabase(PatternDatabase& pdb, const string& pdbFile, ostream& log) {
+    if (!pdb.load(pdbFile)) {
+        log << "Building pattern database..." << endl;
+        auto start = high_resolution_clock::now();
+        pdb.build();
+        auto stop = high_resolution_clock::now();
+        log << "Pattern database built in " << duration_cast<milliseconds>(stop - start).count() << " ms" << endl;
+        if (pdb.save(pdbFile)) {
+            pdb.load(pdbFile);
+        }
+    }
+}
+
+// ========== Замеры производительности ==========
+// Корпус: позиции по возрастанию длины решения, каждый алгоритм только на тех глубинах,
+// где он укладывается в секунды. Число узлов параллельного IDA* зависит от планирования потоков.
+static int runBenchmarks(const BenchmarkOptions& options, const PatternDatabase* pdb) {
+    struct Board {
+        const char* name;
+        const char* board;
+    };
+    const Board boards[] = {
+        { "d05", "1234067859ACDEBF" },
+        { "d13", "1723068459ACDEBF" },
+        { "d19", "12345678A0BE9FCD" },
+        { "d35", "75123804A6BE9FCD" },
+        { "d52", "FE169B4C0A73D852" },
+    };
+    struct Engine {
+        const char* name;
+        int typeSol;
+        Puzzle15Solver::Heuristic heuristic;
+        int maxDepth; // самая длинная позиция корпуса для алгоритма
+    };
+    const Engine engines[] = {
+        { "bfs", 0, Puzzle15Solver::Heuristic::Default, 19 },
+        { "bibfs", 6, Puzzle15Solver::Heuristic::Default, 35 },
+        { "astar", 3, Puzzle15Solver::Heuristic::Default, 52 },
+        { "ida", 4, Puzzle15Solver::Heuristic::Default, 52 },
+        { "ida-wd", 4, Puzzle15Solver::Heuristic::WalkingDistance, 52 },
+        { "ida-pdb", 4, Puzzle15Solver::Heuristic::PatternDatabase, 52 },
+        { "parallel-ida", 5, Puzzle15Solver::Heuristic::Default, 52 },
+    };
+
+    Puzzle15Solver solver;
+    solver.setVerbose(false);
+    solver.setPatternDatabase(pdb);
+
+    BenchmarkSuite suite(options);
+    for (const Engine& engine : engines) {
+        for (const Board& board : boards) {
+            if (atoi(board.name + 1) > engine.maxDepth) continue;
+            if (engine.heuristic == Puzzle15Solver::Heuristic::PatternDatabase && !pdb->isLoaded()) continue;
+            Engine e = engine;
+            string input = board.board;
+            suite.add(string(engine.name) + "/" + board.name, [&solver, e, input]() {
+                solver.setHeuristic(e.heuristic);
+                solver.solve(input, e.typeSol);
+                return solver.getLastStatesVisited();
+                });
+        }
+    }
+    return suite.run(cout);
+}
+
+int main(int argc, char* argv[]) {
+    const string pdbFile = "pdb663.bin";
+    PatternDatabase pdb;
+
+    // IS_2 --bench [--warmup N] [--reps N] [--filter S] [--save file] [--baseline file] [--tolerance X]
+    BenchmarkOptions benchOptions;
+    if (parseBenchmarkArgs(argc, argv, benchOptions)) {
+        loadPatternDatabase(pdb, pdbFile, cerr);
+        return runBenchmarks(benchOptions, &pdb);
+    }
+
+    // IS_2 --batch <file|-> [--threads N] [--algo 0-6] [--format csv|json] [--out file] [--pdb] [--phase-timing]
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) != "--batch") continue;
+        BatchOptions options;
+        // файл - следующий аргумент, если это не ключ; иначе стандартный ввод
+        if (i + 1 < argc && (string(argv[i + 1]) == "-" || string(argv[i + 1]).compare(0, 2, "--") != 0)) {
+            options.inputFile = argv[i + 1];
+        }
+        for (int j = 1; j < argc; j++) {
+            string arg = argv[j];
+            if (arg == "--threads" && j + 1 < argc) {
+                if (!parseIntArg(argv[++j], 0, 1024, options.threads)) {
+                    cerr << "Invalid --threads value: " << argv[j] << " (expected 0-1024)" << endl;
+                    return 1;
+                }
+            }
+            else if (arg == "--algo" && j + 1 < argc) {
+                if (!parseIntArg(argv[++j], 0, 6, options.typeSol)) {
+                    cerr << "Invalid --algo value: " << argv[j] << " (expected 0-6)" << endl;
+                    return 1;
+                }
+            }
+            else if (arg == "--format" && j + 1 < argc) {
+                options.format = argv[++j];
+                if (options.format != "csv" && options.format != "json") {
+                    cerr << "Invalid --format value: " << options.format << " (expected csv or json)" << endl;
+                    return 1;
+                }
+            }
+            else if (arg == "--out" && j + 1 < argc) options.outputFile = argv[++j];
+            else if (arg == "--pdb") options.usePatternDb = true;
+            else if (arg == "--phase-timing") options.phaseTiming = true;
+        }
+        if (options.usePatternDb) {
+            loadPatternDatabase(pdb, pdbFile, cerr);
+        }
+        return runBatch(options, &pdb);
+    }
+
     Puzzle15Solver solver;
     string input;
 
+    // База шаблонов строится один раз и затем отображается в память из файла
+    loadPatternDatabase(pdb, pdbFile, cout);
+    solver.setPatternDatabase(&pdb);
+
     cout << "===ALL SOL===\n" << endl;
     input = "1234067859ACDEBF";//5
     solver.printAllSolutions(input);
@@ -660,5 +2009,27 @@ int main() {
     input = "FE169B4C0A73D852";//52
     solver.printASolutions(input);
 
+    cout << "\n===PATTERN DATABASE 6-6-3===\n" << endl;
+    solver.setHeuristic(Puzzle15Solver::Heuristic::PatternDatabase);
+    input = "75123804A6BE9FCD";//35
+    solver.printASolutions(input);
+    input = "FE169B4C0A73D852";//52
+    solver.printASolutions(input);
+    solver.setHeuristic(Puzzle15Solver::Heuristic::Default);
+
+    cout << "\n===A* OPEN LIST: HEAP VS BUCKETS===\n" << endl;
+    input = "75123804A6BE9FCD";//35
+    solver.compareOpenLists(input);
+    input = "FE169B4C0A73D852";//52
+    solver.compareOpenLists(input);
+
+    cout << "\n===HEURISTICS: MANHATTAN + CONFLICTS VS WALKING DISTANCE===\n" << endl;
+    input = "12345678A0BE9FCD";//19
+    solver.compareHeuristics(input);
+    input = "75123804A6BE9FCD";//35
+    solver.compareHeuristics(input);
+    input = "FE169B4C0A73D852";//52
+    solver.compareHeuristics(input);
+
     return 0;
 }
\ No newline at end of file
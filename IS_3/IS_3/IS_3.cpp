@@ -3,13 +3,19 @@
 #include <queue>
 #include <stack>
 #include <unordered_map>
-#include <unordered_set>
 #include <chrono>
 #include <bitset>
 #include <array>
 #include <functional>
 #include <algorithm>
 #include <limits>
+#include <climits>
+
+#include "../../Common/FlatStateTable.h"
+#include "../../Common/IncrementalAssignment.h"
+#include "../../Common/SearchStats.h"
+#include "../../Common/Benchmark.h"
+#include "../../Common/CornersEngine.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -41,32 +47,39 @@ struct BoardState {
 
 struct BoardHash {
     size_t operator()(const BoardState& s) const noexcept {
-        return std::hash<uint64_t>()(s.white ^ (s.black << 1));
+        return (size_t)mixStateHash(s.white ^ mixStateHash(s.black));
     }
 };
 
 // ========== Узел A* ==========
+// Узлы поиска лежат в одном векторе (арене) и ссылаются на родителя 32-битным индексом,
+// арена освобождается целиком по окончании поиска
 struct Node {
     BoardState state;
     int g, h, f;
-    shared_ptr<Node> parent;
-    int moveFrom = -1, moveTo = -1;
-
-    Node(const BoardState& s, int g_, int h_,
-        shared_ptr<Node> p = nullptr, int f_ = -1, int t_ = -1)
-        : state(s), g(g_), h(h_), parent(p), moveFrom(f_), moveTo(t_) {
-        f = (f_ == -1 ? g + h : f_);
-    }
+    uint32_t parent;
+    int8_t moveFrom, moveTo;
 };
 
+const uint32_t NO_PARENT = UINT32_MAX;
+
 // ========== Класс решателя ==========
 class CornersSolver {
 public:
     BoardState initial, goal;
     vector<int> whiteGoalPositions, blackGoalPositions;
-    long long nodesExplored = 0;
+    SearchStats stats;
+    bool verbose = true; // печатать ход поиска
 
-    CornersSolver() { initGoals(); }
+    // назначения раскрываемой позиции для эвристики потомков
+    IncrementalAssignment assignment[2];
+    int parentPieces[2][IncrementalAssignment::MAX_SIZE];
+    int parentCost[2] = { 0, 0 };
+
+    // ходы и расстановка - из общего движка «Уголков», прыжки цепочкой
+    CornersEngine<BOARD_SIZE, BOARD_SIZE> engine;
+
+    CornersSolver() : engine(2, 2, CornersRules{ true }) { initGoals(); }
 
     void initGoals() {
         // Нижний левый угол – белые, верхний правый – чёрные
@@ -78,17 +91,9 @@ public:
             for (int x = 2; x < 4; x++)
                 blackGoalPositions.push_back(BoardState::pos(x, y));
 
-        // начальное состояние
-        initial.white = 0;
-        initial.black = 0;
-
-        for (int y = 2; y < 4; y++)
-            for (int x = 2; x < 4; x++)
-                initial.white |= 1ULL << BoardState::pos(x, y);
-
-        for (int y = 0; y < 2; y++)
-            for (int x = 0; x < 2; x++)
-                initial.black |= 1ULL << BoardState::pos(x, y);
+        // начальное состояние: белые в дальнем углу движка, чёрные - в углу (0, 0)
+        initial.white = engine.layout.blackCorner;
+        initial.black = engine.layout.whiteCorner;
 
         // целевое состояние
         goal.white = initial.black;
@@ -96,167 +101,98 @@ public:
     }
 
     // Манхэттен
-    int manhattan(int a, int b) {
+    int manhattan(int a, int b) const {
         int x1 = a % BOARD_SIZE, y1 = a / BOARD_SIZE;
         int x2 = b % BOARD_SIZE, y2 = b / BOARD_SIZE;
         return abs(x1 - x2) + abs(y1 - y2);
     }
 
-    int hungarian(const vector<vector<int>>& cost) {
-        int n = cost.size();
-        int m = cost[0].size();
-        int dim = max(n, m);
-        vector<vector<int>> a(dim, vector<int>(dim, 0));
-
-        for (int i = 0; i < n; i++)
-            for (int j = 0; j < m; j++)
-                a[i][j] = cost[i][j];
-
-        vector<int> u(dim + 1), v(dim + 1), p(dim + 1), way(dim + 1);
-
-        for (int i = 1; i <= dim; i++) {
-            p[0] = i;
-            int j0 = 0;
-            vector<int> minv(dim + 1, INT_MAX);
-            vector<char> used(dim + 1, false);
-            do {
-                used[j0] = true;
-                int i0 = p[j0], delta = INT_MAX, j1 = 0;
-                for (int j = 1; j <= dim; j++) {
-                    if (used[j]) continue;
-                    int cur = a[i0 - 1][j - 1] - u[i0] - v[j];
-                    if (cur < minv[j]) minv[j] = cur, way[j] = j0;
-                    if (minv[j] < delta) delta = minv[j], j1 = j;
-                }
-                for (int j = 0; j <= dim; j++) {
-                    if (used[j]) { u[p[j]] += delta; v[j] -= delta; }
-                    else minv[j] -= delta;
-                }
-                j0 = j1;
-            } while (p[j0] != 0);
-            do {
-                int j1 = way[j0];
-                p[j0] = p[j1];
-                j0 = j1;
-            } while (j0);
-        }
-
-        return -v[0]; // минимальная стоимость
-    }
-
-
     // ========== Эвристика ==========
+    // Для каждого цвета - минимальная по назначениям шашек целевым клеткам сумма манхэттенских
+    // расстояний. setHeuristicParent решает обе задачи о назначениях для раскрываемой позиции,
+    // childHeuristic оценивает потомка: ход меняет строку одной шашки, и назначение её цвета
+    // чинится одним увеличивающим путём
     int advancedHeuristic(const BoardState& state) {
         if (state == goal) return 0;
+        setHeuristicParent(state);
+        return parentCost[0] + parentCost[1];
+    }
 
-        vector<int> whitePositions, blackPositions;
-        for (int pos = 0; pos < 16; pos++) {
-            if (state.white & (1ULL << pos)) whitePositions.push_back(pos);
-            if (state.black & (1ULL << pos)) blackPositions.push_back(pos);
+    void setHeuristicParent(const BoardState& state) {
+        int cost[IncrementalAssignment::MAX_SIZE * IncrementalAssignment::MAX_SIZE];
+        for (int color = 0; color < 2; color++) {
+            uint64_t pieces = color == 0 ? state.white : state.black;
+            const vector<int>& goals = color == 0 ? whiteGoalPositions : blackGoalPositions;
+            int n = 0;
+            for (int pos = 0; pos < 16; pos++) {
+                if (pieces & (1ULL << pos)) parentPieces[color][n++] = pos;
+            }
+            for (int i = 0; i < n; i++)
+                for (int j = 0; j < n; j++)
+                    cost[i * n + j] = manhattan(parentPieces[color][i], goals[j]);
+            parentCost[color] = assignment[color].solve(cost, n);
         }
-
-        auto buildCost = [&](const vector<int>& from, const vector<int>& to) {
-            vector<vector<int>> cost(from.size(), vector<int>(to.size()));
-            for (int i = 0; i < (int)from.size(); i++)
-                for (int j = 0; j < (int)to.size(); j++)
-                    cost[i][j] = manhattan(from[i], to[j]);
-            return cost;
-            };
-
-        int distW = hungarian(buildCost(whitePositions, whiteGoalPositions));
-        int distB = hungarian(buildCost(blackPositions, blackGoalPositions));
-
-        return (distW + distB);
     }
 
+    // Оценка потомка позиции, переданной в setHeuristicParent, после хода from -> to
+    // (для цепочки прыжков - исходная и конечная клетки шашки)
+    int childHeuristic(const BoardState& parent, int from, int to) const {
+        int color = (parent.white >> from) & 1 ? 0 : 1;
+        const vector<int>& goals = color == 0 ? whiteGoalPositions : blackGoalPositions;
+        int n = assignment[color].rows();
+        int row = 0;
+        while (parentPieces[color][row] != from) row++;
+        int rowCost[IncrementalAssignment::MAX_SIZE];
+        for (int j = 0; j < n; j++) rowCost[j] = manhattan(to, goals[j]);
+        return assignment[color].withRow(row, rowCost) + parentCost[1 - color];
+    }
 
-    // ========== Мультипрыжки ==========
-    void addJumpChains(const BoardState& state, int pos, bool isWhite,
-        vector<pair<BoardState, pair<int, int>>>& moves,
-        unordered_set<int> visited) {
-        int x = pos % BOARD_SIZE;
-        int y = pos / BOARD_SIZE;
-        int dx[] = { 1, -1, 0, 0 };
-        int dy[] = { 0, 0, 1, -1 };
-
-        for (int i = 0; i < 4; i++) {
-            int mx = x + dx[i];
-            int my = y + dy[i];
-            int jx = x + 2 * dx[i];
-            int jy = y + 2 * dy[i];
-            if (jx < 0 || jy < 0 || jx >= BOARD_SIZE || jy >= BOARD_SIZE)
-                continue;
-
-            int mid = BoardState::pos(mx, my);
-            int jump = BoardState::pos(jx, jy);
-
-            if (state.isOccupied(mid) && !state.isOccupied(jump) && !visited.count(jump)) {
-                BoardState newState = state;
-                newState.movePiece(pos, jump, isWhite);
-                moves.emplace_back(newState, make_pair(pos, jump));
 
-                auto newVisited = visited;
-                newVisited.insert(pos);
-                addJumpChains(newState, jump, isWhite, moves, newVisited);
-            }
-        }
+    // Эвристика с учётом в статистике
+    int evaluate(const BoardState& state) {
+        PhaseTimer timer(stats.timePhases, stats.heuristicMs);
+        stats.heuristicEvaluations++;
+        return advancedHeuristic(state);
     }
 
-    void addMovesForPiece(const BoardState& state, int pos, bool isWhite,
-        vector<pair<BoardState, pair<int, int>>>& moves) {
-        int x = pos % BOARD_SIZE;
-        int y = pos / BOARD_SIZE;
-        int dx[] = { 1, -1, 0, 0 };
-        int dy[] = { 0, 0, 1, -1 };
-
-        // простые ходы
-        for (int i = 0; i < 4; i++) {
-            int nx = x + dx[i];
-            int ny = y + dy[i];
-            if (nx >= 0 && nx < BOARD_SIZE && ny >= 0 && ny < BOARD_SIZE) {
-                int np = BoardState::pos(nx, ny);
-                if (!state.isOccupied(np)) {
-                    BoardState newState = state;
-                    newState.movePiece(pos, np, isWhite);
-                    moves.emplace_back(newState, make_pair(pos, np));
-                }
-            }
-        }
-
-        // цепочки прыжков
-        unordered_set<int> visited;
-        addJumpChains(state, pos, isWhite, moves, visited);
+    int evaluateChild(const BoardState& parent, int from, int to) {
+        PhaseTimer timer(stats.timePhases, stats.heuristicMs);
+        stats.heuristicEvaluations++;
+        return childHeuristic(parent, from, to);
     }
 
-    vector<pair<BoardState, pair<int, int>>> getMoves(const BoardState& state) {
-        vector<pair<BoardState, pair<int, int>>> moves;
-        for (int pos = 0; pos < 16; pos++) {
-            if (state.white & (1ULL << pos))
-                addMovesForPiece(state, pos, true, moves);
-            else if (state.black & (1ULL << pos))
-                addMovesForPiece(state, pos, false, moves);
-        }
+    // ========== Ходы ==========
+    // Ходы позиции в массиве фиксированного размера: шашка уходит только на свободную клетку,
+    // поэтому ходов не больше (число шашек) * (число свободных клеток)
+    struct MoveList {
+        static const int MAX_MOVES = 2 * NUM_PIECES * (BOARD_SIZE * BOARD_SIZE - 2 * NUM_PIECES);
+        pair<BoardState, pair<int, int>> items[MAX_MOVES];
+        int count = 0;
 
-        // фильтр дубликатов
-        unordered_set<uint64_t> seen;
-        vector<pair<BoardState, pair<int, int>>> unique;
-        for (auto& m : moves) {
-            uint64_t h = m.first.white ^ (m.first.black << 1);
-            if (!seen.count(h)) {
-                seen.insert(h);
-                unique.push_back(m);
-            }
+        void add(const BoardState& state, int from, int to) {
+            items[count++] = make_pair(state, make_pair(from, to));
         }
-        return unique;
+        const pair<BoardState, pair<int, int>>* begin() const { return items; }
+        const pair<BoardState, pair<int, int>>* end() const { return items + count; }
+        size_t size() const { return count; }
+    };
+
+    // Разные шашки дают разные позиции, а движок не повторяет клетки одной шашки,
+    // поэтому ходы без повторов. Ход - исходная и конечная клетки цепочки
+    void getMoves(const BoardState& state, MoveList& moves) {
+        moves.count = 0;
+        engine.forEachMove(state.white, state.black, [&](int from, int to) {
+            BoardState newState = state;
+            newState.movePiece(from, to, (state.white >> from) & 1);
+            moves.add(newState, from, to);
+            });
     }
 
     // ========== Восстановление пути ==========
-    vector<pair<int, int>> reconstructPath(shared_ptr<Node> node) {
+    vector<pair<int, int>> reconstructPath(const vector<Node>& nodes, uint32_t index) {
         vector<pair<int, int>> path;
-        while (node && node->parent) {
-            path.emplace_back(node->moveFrom, node->moveTo);
-            node = node->parent;
-        }
+        for (; nodes[index].parent != NO_PARENT; index = nodes[index].parent)
+            path.emplace_back(nodes[index].moveFrom, nodes[index].moveTo);
         reverse(path.begin(), path.end());
         return path;
     }
@@ -264,78 +200,102 @@ public:
     // ========== Решатель A* ==========
     vector<pair<int, int>> solveAStar() {
         auto startTime = high_resolution_clock::now();
-        nodesExplored = 0;
-
-        struct Cmp {
-            bool operator()(const shared_ptr<Node>& a, const shared_ptr<Node>& b) const {
-                return a->f > b->f;
-            }
-        };
-
-        priority_queue<shared_ptr<Node>, vector<shared_ptr<Node>>, Cmp> openSet;
-        unordered_map<BoardState, int, BoardHash> gValues;
-        unordered_set<BoardState, BoardHash> closedSet;
-
-        int h0 = advancedHeuristic(initial);
-        auto start = make_shared<Node>(initial, 0, h0);
-        openSet.push(start);
+        stats.begin();
+
+        // в очереди только пары (f, индекс узла в арене)
+        typedef pair<int, uint32_t> OpenEntry;
+        vector<Node> nodes;
+        nodes.reserve(1 << 16);
+        priority_queue<OpenEntry, vector<OpenEntry>, greater<OpenEntry>> openSet;
+        FlatStateTable<BoardState, int, BoardHash> gValues(1 << 16);
+        FlatStateSet<BoardState, BoardHash> closedSet(1 << 16);
+
+        int h0 = evaluate(initial);
+        nodes.push_back({ initial, 0, h0, h0, NO_PARENT, -1, -1 });
+        openSet.emplace(h0, 0);
         gValues[initial] = 0;
 
         int bestF = INT_MAX;
+        MoveList nextMoves;
 
-        cout << "A* started (h=" << h0 << ")\n";
+        if (verbose) cout << "A* started (h=" << h0 << ")\n";
 
         while (!openSet.empty()) {
-            auto current = openSet.top();
+            uint32_t index = openSet.top().second;
             openSet.pop();
+            const Node current = nodes[index];
 
-            if (closedSet.count(current->state)) continue;
-            closedSet.insert(current->state);
-            nodesExplored++;
+            if (!closedSet.insert(current.state).second) {
+                stats.duplicates++;
+                continue;
+            }
+            stats.expanded++;
 
-            if (current->state == goal) {
+            if (current.state == goal) {
+                stats.finish();
                 auto endTime = high_resolution_clock::now();
                 auto dur = duration_cast<milliseconds>(endTime - startTime);
-                cout << "\n✅ A* completed in " << dur.count() << " ms, "
-                    << nodesExplored << " nodes.\n";
-                return reconstructPath(current);
+                if (verbose) cout << "\n✅ A* completed in " << dur.count() << " ms, "
+                    << stats.expanded << " nodes.\n";
+                return reconstructPath(nodes, index);
             }
 
-            if (nodesExplored > 5000000) {
-                cout << "⚠️  Search stopped (too many nodes)\n";
-                return reconstructPath(current);
+            if (stats.expanded > 5000000) {
+                stats.finish();
+                if (verbose) cout << "⚠️  Search stopped (too many nodes)\n";
+                return reconstructPath(nodes, index);
             }
 
-            auto nextMoves = getMoves(current->state);
+            {
+                PhaseTimer timer(stats.timePhases, stats.moveGenMs);
+                getMoves(current.state, nextMoves);
+            }
+            stats.generated += nextMoves.size();
+            {
+                PhaseTimer timer(stats.timePhases, stats.heuristicMs);
+                setHeuristicParent(current.state);
+            }
             for (auto& mv : nextMoves) {
                 const BoardState& ns = mv.first;
-                int newG = current->g + 1;
-                if (closedSet.count(ns)) continue;
+                int newG = current.g + 1;
+                if (closedSet.contains(ns)) {
+                    stats.duplicates++;
+                    continue;
+                }
 
-                int newH = advancedHeuristic(ns);
+                int newH = evaluateChild(current.state, mv.second.first, mv.second.second);
                 int newF = newG + int(newH * 1.2); // Weighted A*
-                if (newF >= bestF) continue;
+                if (newF >= bestF) {
+                    stats.cutoffs++;
+                    continue;
+                }
 
-                if (!gValues.count(ns) || newG < gValues[ns]) {
+                int* oldG = gValues.find(ns);
+                if (oldG == nullptr || newG < *oldG) {
                     gValues[ns] = newG;
-                    auto newNode = make_shared<Node>(ns, newG, newH, current,
-                        mv.second.first, mv.second.second);
-                    openSet.push(newNode);
+                    nodes.push_back({ ns, newG, newH, newF, index,
+                        int8_t(mv.second.first), int8_t(mv.second.second) });
+                    openSet.emplace(newF, uint32_t(nodes.size() - 1));
+                    stats.noteOpenSize(openSet.size());
                     if (newH == 0) bestF = min(bestF, newF);
                 }
+                else {
+                    stats.duplicates++;
+                }
             }
 
-            if (nodesExplored % 10000 == 0) {
+            if (verbose && stats.expanded % 10000 == 0) {
                 auto t = duration_cast<milliseconds>(
                     high_resolution_clock::now() - startTime);
-                cout << "A* explored " << nodesExplored
-                    << " nodes, f=" << current->f
-                    << " (g=" << current->g << ", h=" << current->h << ")"
+                cout << "A* explored " << stats.expanded
+                    << " nodes, f=" << current.f
+                    << " (g=" << current.g << ", h=" << current.h << ")"
                     << ", time=" << t.count() << " ms\n";
             }
         }
 
-        cout << "❌ No solution found.\n";
+        stats.finish();
+        if (verbose) cout << "❌ No solution found.\n";
         return {};
     }
 
@@ -406,11 +366,34 @@ public:
     BoardState getGoalState() const { return goal; }
 };
 
-int main() {
+// Замер взвешенного A* на доске 4x4
+static int runBenchmarks(const BenchmarkOptions& options) {
+    BenchmarkSuite suite(options);
+    suite.add("weighted-astar/4x4-2x2", []() {
+        CornersSolver solver;
+        solver.verbose = false;
+        solver.solveAStar();
+        return solver.stats.expanded;
+        });
+    return suite.run(cout);
+}
+
+// IS_3 --bench [--warmup N] [--reps N] [--filter S] [--save file] [--baseline file] [--tolerance X]
+// IS_3 --phase-timing - время эвристики и генерации ходов в статистике
+int main(int argc, char* argv[]) {
+    BenchmarkOptions benchOptions;
+    if (parseBenchmarkArgs(argc, argv, benchOptions)) {
+        return runBenchmarks(benchOptions);
+    }
+
     CornersSolver solver;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--phase-timing") solver.stats.timePhases = true;
+    }
     auto path = solver.solveAStar();
 
     cout << "\nMoves: " << path.size() << "\n";
+    cout << "Stats: " << solver.stats.toJson() << "\n";
     for (auto& move : path)  // используем ссылку для избежания копирования
         cout << move.first << " -> " << move.second << "\n";
 